@@ -47,12 +47,13 @@ usage() {
 
 	printf 'usage: %s -h\n' "$script"
 	printf '       %s --help\n' "$script"
-	printf '       %s [-bD|-dB|-c] [-EfgGHMNPST] [-O OPT_LEVEL] [-k KARATSUBA_LEN]\n' "$script"
+	printf '       %s [-bD|-dB|-c] [-EfgGHMNPRST] [-O OPT_LEVEL] [-k KARATSUBA_LEN]\n' "$script"
 	printf '       %s \\\n' "$script"
 	printf '           [--bc-only --disable-dc|--dc-only --disable-bc|--coverage]    \\\n'
 	printf '           [--debug --disable-extra-math --disable-generated-tests]      \\\n'
 	printf '           [--disable-history --disable-man-pages --disable-nls]         \\\n'
 	printf '           [--disable-prompt --disable-signal-handling --disable-strip]  \\\n'
+	printf '           [--disable-threads]                                           \\\n'
 	printf '           [--opt=OPT_LEVEL] [--karatsuba-len=KARATSUBA_LEN]             \\\n'
 	printf '           [--prefix=PREFIX] [--bindir=BINDIR]                           \\\n'
 	printf '           [--datarootdir=DATAROOTDIR] [--datadir=DATADIR]               \\\n'
@@ -109,6 +110,9 @@ usage() {
 	printf '        Disables the prompt in the built bc. The prompt will never show up,\n'
 	printf '        or in other words, it will be permanently disabled and cannot be\n'
 	printf '        enabled.\n'
+	printf '    -R, --disable-threads\n'
+	printf '        Disable threads. If threads are enabled, large multiplications can use\n'
+	printf '        more than one thread, but only if asked for at runtime.\n'
 	printf '    -S, --disable-signal-handling\n'
 	printf '        Disable signal handling. On by default.\n'
 	printf '    -T, --disable-strip\n'
@@ -315,8 +319,9 @@ nls=1
 prompt=1
 force=0
 strip_bin=1
+threads=1
 
-while getopts "bBcdDEfgGhHk:MNO:PST-" opt; do
+while getopts "bBcdDEfgGhHk:MNO:PRST-" opt; do
 
 	case "$opt" in
 		b) bc_only=1 ;;
@@ -335,6 +340,7 @@ while getopts "bBcdDEfgGhHk:MNO:PST-" opt; do
 		N) nls=0 ;;
 		O) optimization="$OPTARG" ;;
 		P) prompt=0 ;;
+		R) threads=0 ;;
 		S) signals=0 ;;
 		T) strip_bin=0 ;;
 		-)
@@ -421,6 +427,7 @@ while getopts "bBcdDEfgGhHk:MNO:PST-" opt; do
 				disable-prompt) prompt=0 ;;
 				disable-signal-handling) signals=0 ;;
 				disable-strip) strip_bin=0 ;;
+				disable-threads) threads=0 ;;
 				help* | bc-only* | dc-only* | coverage* | debug*)
 					usage "No arg allowed for --$arg option" ;;
 				disable-bc* | disable-dc* | disable-extra-math*)
@@ -429,7 +436,7 @@ while getopts "bBcdDEfgGhHk:MNO:PST-" opt; do
 					usage "No arg allowed for --$arg option" ;;
 				disable-man-pages* | disable-nls* | disable-signal-handling*)
 					usage "No arg allowed for --$arg option" ;;
-				disable-strip*)
+				disable-strip* | disable-threads*)
 					usage "No arg allowed for --$arg option" ;;
 				'') break ;; # "--" terminates argument processing
 				* ) usage "Invalid option $LONG_OPTARG" ;;
@@ -751,6 +758,53 @@ if [ "$hist" -eq 1 ]; then
 
 fi
 
+if [ "$threads" -eq 1 ]; then
+
+	set +e
+
+	printf 'Testing threads...\n'
+
+	# Only test that pthreads compile and link; errors in bc's own code
+	# should fail the build, not disable threads.
+	printf '#include <pthread.h>\n' > "$scriptdir/threads.c"
+	printf 'static void* f(void* p) { return p; }\n' >> "$scriptdir/threads.c"
+	printf 'int main(void) {\n' >> "$scriptdir/threads.c"
+	printf '\tpthread_t t;\n' >> "$scriptdir/threads.c"
+	printf '\tif (pthread_create(&t, NULL, f, NULL)) return 1;\n' >> "$scriptdir/threads.c"
+	printf '\treturn pthread_join(t, NULL) != 0;\n' >> "$scriptdir/threads.c"
+	printf '}\n' >> "$scriptdir/threads.c"
+
+	flags="-D_POSIX_C_SOURCE=200809L -D_XOPEN_SOURCE=700"
+
+	"$HOSTCC" $HOSTCFLAGS $flags "$scriptdir/threads.c" -o "$scriptdir/threads" \
+		-lpthread > /dev/null 2>&1
+
+	err="$?"
+
+	rm -rf "$scriptdir/threads.c" "$scriptdir/threads"
+
+	# If this errors, it is probably because of building on Windows,
+	# and threads are not supported on Windows, so disable them.
+	if [ "$err" -ne 0 ]; then
+		printf 'Threads do not work.\n'
+		if [ $force -eq 0 ]; then
+			printf 'Disabling threads...\n'
+			threads=0
+		else
+			printf 'Forcing threads...\n'
+		fi
+	else
+		printf 'Threads work.\n'
+	fi
+
+	set -e
+
+fi
+
+if [ "$threads" -eq 1 ]; then
+	LDFLAGS="$LDFLAGS -lpthread"
+fi
+
 if [ "$extra_math" -eq 1 -a "$bc" -ne 0 ]; then
 	BC_LIB2_O="\$(GEN_DIR)/lib2.o"
 else
@@ -789,6 +843,7 @@ printf 'BC_ENABLE_HISTORY=%s\n' "$hist"
 printf 'BC_ENABLE_EXTRA_MATH=%s\n' "$extra_math"
 printf 'BC_ENABLE_NLS=%s\n' "$nls"
 printf 'BC_ENABLE_PROMPT=%s\n' "$prompt"
+printf 'BC_ENABLE_THREADS=%s\n' "$threads"
 printf '\n'
 printf 'BC_NUM_KARATSUBA_LEN=%s\n' "$karatsuba_len"
 printf '\n'
@@ -833,6 +888,7 @@ contents=$(replace "$contents" "HISTORY" "$hist")
 contents=$(replace "$contents" "EXTRA_MATH" "$extra_math")
 contents=$(replace "$contents" "NLS" "$nls")
 contents=$(replace "$contents" "PROMPT" "$prompt")
+contents=$(replace "$contents" "THREADS" "$threads")
 contents=$(replace "$contents" "BC_LIB_O" "$bc_lib")
 contents=$(replace "$contents" "BC_HELP_O" "$bc_help")
 contents=$(replace "$contents" "DC_HELP_O" "$dc_help")
@@ -130,6 +130,7 @@ BcStatus bc_lex_token(BcLex *l);
 	(!(bin_last) && ((rparen) || bc_parse_inst_isLeaf(prev)))
 #define BC_PARSE_INST_VAR(t) \
 	((t) >= BC_INST_VAR && (t) <= BC_INST_SCALE && (t) != BC_INST_ARRAY)
+#define BC_PARSE_INST_GLOBAL(t) ((t) >= BC_INST_IBASE && (t) <= BC_INST_SCALE)
 
 #define BC_PARSE_PREV_PREFIX(p) \
 	((p) >= BC_INST_INC_PRE && (p) <= BC_INST_BOOL_NOT)
@@ -148,6 +149,8 @@ BcStatus bc_parse_expr_status(BcParse *p, uint8_t flags, BcParseNext next);
 // This is necessary to clear up for if statements at the end of files.
 void bc_parse_noElse(BcParse *p);
 
+void bc_opt_loops(BcParse *p);
+
 #if BC_ENABLE_SIGNALS
 extern const char bc_sig_msg[];
 #endif // BC_ENABLE_SIGNALS
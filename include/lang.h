@@ -161,6 +161,14 @@ typedef enum BcInst {
 	BC_INST_RET_VOID,
 
 	BC_INST_HALT,
+
+	BC_INST_CACHE,
+	BC_INST_CACHE_SAVE,
+	BC_INST_CACHE_CLEAR,
+
+	BC_INST_GLOBAL_SAVE,
+	BC_INST_GLOBAL_RESTORE,
+	BC_INST_GLOBAL_SET,
 #endif // BC_ENABLED
 
 	BC_INST_POP,
@@ -210,6 +218,23 @@ typedef struct BcConst {
 	BcNum num;
 } BcConst;
 
+// A string, and what printing it with escapes prints, which is the same
+// pointer if it has no backslashes. col is how many characters are after the
+// last newline that is printed, or SIZE_MAX if there is none.
+typedef struct BcStr {
+	char *val;
+	char *esc;
+	size_t len;
+	size_t col;
+} BcStr;
+
+typedef enum BcFuncCheck {
+	BC_FUNC_CHECK_UNKNOWN,
+	BC_FUNC_CHECK_RUNNING,
+	BC_FUNC_CHECK_YES,
+	BC_FUNC_CHECK_NO,
+} BcFuncCheck;
+
 typedef struct BcFunc {
 
 	BcVec code;
@@ -223,8 +248,35 @@ typedef struct BcFunc {
 	BcVec consts;
 
 	const char *name;
+
+	// Whether the code was proven to never use more results than it pushed
+	// and to only use numbers where they are needed, so that it can run
+	// without checking. In dc, only the code before the first instruction that
+	// can run a string is proven.
+	BcFuncCheck verified;
+
 #if BC_ENABLED
 	bool voidfn;
+
+	// The math library function that this is, if bc_num_series() can do it.
+	char series;
+
+	// Whether the function only depends on its arguments and the globals,
+	// and, if memoization is on, the values it returned for each of those.
+	BcFuncCheck pure;
+	BcVec memo_map;
+	BcVec memo;
+	size_t memo_size;
+
+	// Whether the function only touches its own parameters and autos, and
+	// whether it only passes its arguments on to such a function, and which.
+	BcFuncCheck closed;
+	BcFuncCheck fwd;
+	size_t fwd_func;
+
+	// Whether the function may change ibase, obase, or scale, which means
+	// that, with -g, they have to be saved when it is called.
+	BcFuncCheck globals;
 #endif // BC_ENABLED
 
 } BcFunc;
@@ -269,6 +321,7 @@ typedef struct BcInstPtr {
 	size_t func;
 	size_t idx;
 	size_t len;
+	bool checks;
 } BcInstPtr;
 
 typedef enum BcType {
@@ -286,11 +339,16 @@ BcStatus bc_func_insert(BcFunc *f, struct BcProgram* p, char* name,
                         BcType type, size_t line);
 void bc_func_reset(BcFunc *f);
 void bc_func_free(void *func);
+#if BC_ENABLED
+void bc_func_forget(BcFunc *f);
+#endif // BC_ENABLED
 
 void bc_array_init(BcVec *a, bool nums);
 void bc_array_copy(BcVec *d, const BcVec *s);
 
 void bc_string_free(void *string);
+void bc_str_init(BcStr *s, char *val);
+void bc_str_free(void *str);
 void bc_const_free(void *constant);
 void bc_id_free(void *id);
 void bc_result_copy(BcResult *d, BcResult *src);
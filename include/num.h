@@ -122,6 +122,32 @@ typedef struct BcNum {
 #error BC_NUM_KARATSUBA_LEN must be at least 16.
 #endif // BC_NUM_KARATSUBA_LEN
 
+// Karatsuba only hands sub-products to other threads when the halves are at
+// least this many limbs; below that, starting a thread costs too much.
+#define BC_NUM_THREAD_LEN (BC_NUM_KARATSUBA_LEN * 16)
+
+// Radix conversion is split between threads down to pieces of this many
+// digits of obase^N (when printing) or BC_BASE_DIGS characters (when parsing).
+#define BC_NUM_CONV_LEN (BC_NUM_THREAD_LEN)
+
+#if BC_ENABLED
+
+// At and above this scale, the math library's e(), l(), and a() are evaluated
+// natively by binary splitting. Below it, the library code is fast enough.
+#define BC_NUM_SERIES_SCALE (BC_NUM_KARATSUBA_LEN * BC_BASE_DIGS)
+
+// Extra digits carried while evaluating a series.
+#define BC_NUM_SERIES_GUARD (10)
+
+// The largest argument that e() is evaluated natively for.
+#define BC_NUM_SERIES_EXP_MAX (BC_NUM_BIGDIG_C(1024))
+
+// Binary splitting hands the upper half of a range of terms to another thread
+// when the range is at least this long.
+#define BC_NUM_SERIES_THREAD_TERMS (256)
+
+#endif // BC_ENABLED
+
 // A crude, but always big enough, calculation of
 // the size required for ibase and obase BcNum's.
 #define BC_NUM_BIGDIG_LOG10 ((CHAR_BIT * sizeof(BcBigDig) + 1) / 2 + 1)
@@ -130,10 +156,32 @@ typedef struct BcNum {
 #define BC_NUM_ZERO(n) (!BC_NUM_NONZERO(n))
 #define BC_NUM_ONE(n) ((n)->len == 1 && (n)->rdx == 0 && (n)->num[0] == 1)
 
+// Integers that fit in one limb, which bc_num_smallAdd() and bc_num_smallMul()
+// handle without the general code.
+#define BC_NUM_SMALL(n) ((n)->len <= 1 && !(n)->rdx && !(n)->scale)
+
 #define BC_NUM_NUM_LETTER(c) ((c) - 'A' + BC_BASE)
 
+// Divisors of at least this many limbs that are used more than once get a
+// Barrett reciprocal, which is kept in a cache with this many entries.
+#define BC_NUM_BARRETT_LEN (BC_NUM_KARATSUBA_LEN * 8)
+#define BC_NUM_RECIP_CACHE (4)
+
+// How many freed digit arrays of the default size are kept for new numbers.
+#define BC_NUM_POOL (64)
+
 #define BC_NUM_KARATSUBA_ALLOCS (6)
 
+// How many partial products a column sum in the schoolbook multiply can take,
+// on top of a partial limb, before its carry has to be split off.
+#define BC_NUM_MUL_TILE \
+	((size_t) ((BC_NUM_BIGDIG_MAX - BC_BASE_POW) / \
+	           ((BcBigDig) (BC_BASE_POW - 1) * (BC_BASE_POW - 1))))
+
+// Comparisons check this many limbs at a time, most significant first, before
+// looking at single limbs or checking for signals.
+#define BC_NUM_CMP_BLOCK (64)
+
 #define BC_NUM_CMP_SIGNAL_VAL (~((ssize_t) ((size_t) SSIZE_MAX)))
 #define BC_NUM_CMP_SIGNAL(cmp) (cmp == BC_NUM_CMP_SIGNAL_VAL)
 
@@ -156,6 +204,61 @@ typedef size_t (*BcNumBinaryOpReq)(const BcNum*, const BcNum*, size_t);
 typedef void (*BcNumDigitOp)(size_t, size_t, bool);
 typedef BcStatus (*BcNumShiftAddOp)(BcDig*, const BcDig*, size_t);
 
+typedef struct BcNumRecip {
+	BcNum m;
+	BcNum mu;
+} BcNumRecip;
+
+typedef struct BcNumMulTask {
+	BcNum *a;
+	BcNum *b;
+	BcNum *c;
+} BcNumMulTask;
+
+typedef struct BcNumParseTask {
+	BcNum *pows;
+	size_t k;
+	const char *val;
+	size_t len;
+	BcBigDig base;
+	BcNum n;
+} BcNumParseTask;
+
+typedef struct BcNumPrintTask {
+	BcNum *pows;
+	size_t k;
+	BcDig *digs;
+	BcBigDig rem;
+	BcBigDig pow;
+	BcNum n;
+} BcNumPrintTask;
+
+#if BC_ENABLED
+
+// A series whose term n has the ratio p/q to term n-1 (p0/q0 for the first
+// term), divided by 2n+1 if odd is true. If fact is true, q is also
+// multiplied by n.
+typedef struct BcNumBSplit {
+	BcNum p0;
+	BcNum q0;
+	BcNum p;
+	BcNum q;
+	bool odd;
+	bool fact;
+} BcNumBSplit;
+
+typedef struct BcNumBSplitTask {
+	BcNumBSplit *bs;
+	size_t lo;
+	size_t hi;
+	BcNum p;
+	BcNum q;
+	BcNum b;
+	BcNum t;
+} BcNumBSplitTask;
+
+#endif // BC_ENABLED
+
 void bc_num_init(BcNum *restrict n, size_t req);
 void bc_num_setup(BcNum *restrict n, BcDig *restrict num, size_t cap);
 void bc_num_copy(BcNum *d, const BcNum *s);
@@ -169,12 +272,17 @@ size_t bc_num_len(const BcNum *restrict n);
 BcStatus bc_num_bigdig(const BcNum *restrict n, BcBigDig *result);
 void bc_num_bigdig2num(BcNum *restrict n, BcBigDig val);
 
+void bc_num_smallAdd(const BcNum *a, const BcNum *b, BcNum *c, bool sub);
+void bc_num_smallMul(const BcNum *a, const BcNum *b, BcNum *c);
+
 BcStatus bc_num_add(BcNum *a, BcNum *b, BcNum *c, size_t scale);
 BcStatus bc_num_sub(BcNum *a, BcNum *b, BcNum *c, size_t scale);
 BcStatus bc_num_mul(BcNum *a, BcNum *b, BcNum *c, size_t scale);
 BcStatus bc_num_div(BcNum *a, BcNum *b, BcNum *c, size_t scale);
 BcStatus bc_num_mod(BcNum *a, BcNum *b, BcNum *c, size_t scale);
 BcStatus bc_num_pow(BcNum *a, BcNum *b, BcNum *c, size_t scale);
+BcStatus bc_num_fma(BcNum *a, BcNum *b, BcNum *c, BcNum *restrict d,
+                    size_t scale);
 #if BC_ENABLE_EXTRA_MATH
 BcStatus bc_num_places(BcNum *a, BcNum *b, BcNum *c, size_t scale);
 BcStatus bc_num_lshift(BcNum *a, BcNum *b, BcNum *c, size_t scale);
@@ -183,6 +291,11 @@ BcStatus bc_num_rshift(BcNum *a, BcNum *b, BcNum *c, size_t scale);
 BcStatus bc_num_sqrt(BcNum *restrict a, BcNum *restrict b, size_t scale);
 BcStatus bc_num_divmod(BcNum *a, BcNum *b, BcNum *c, BcNum *d, size_t scale);
 
+#if BC_ENABLED
+BcStatus bc_num_series(BcNum *a, BcNum *restrict b, size_t scale, char fn,
+                       bool *done);
+#endif // BC_ENABLED
+
 size_t bc_num_addReq(const BcNum* a, const BcNum* b, size_t scale);
 
 size_t bc_num_mulReq(const BcNum *a, const BcNum *b, size_t scale);
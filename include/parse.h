@@ -74,6 +74,17 @@ struct BcProgram;
 typedef BcStatus (*BcParseParse)(struct BcParse*);
 typedef BcStatus (*BcParseExpr)(struct BcParse*, uint8_t);
 
+#if BC_ENABLED
+// A loop that is being parsed: the index of the label that jumps back to its
+// condition and where its code starts and ends. The end is SIZE_MAX until the
+// loop is finished.
+typedef struct BcParseLoop {
+	size_t label;
+	size_t bgn;
+	size_t end;
+} BcParseLoop;
+#endif // BC_ENABLED
+
 typedef struct BcParse {
 
 	BcLex l;
@@ -82,6 +93,7 @@ typedef struct BcParse {
 	BcVec flags;
 	BcVec exits;
 	BcVec conds;
+	BcVec loops;
 	BcVec ops;
 	BcVec buf;
 #endif // BC_ENABLED
@@ -50,6 +50,10 @@
 
 #define BC_PROG_ONE_CAP (1)
 
+// How many bytes of keys and results each function may remember before its
+// memoized results are thrown away.
+#define BC_PROG_MEMO_SIZE (1 << 22)
+
 typedef struct BcProgram {
 
 	BcBigDig globals[BC_PROG_GLOBALS_LEN];
@@ -80,6 +84,11 @@ typedef struct BcProgram {
 
 #if BC_ENABLED
 	BcNum last;
+
+	// Calls to pure functions that are running, with the keys that their
+	// results will be memoized under and the depths of their stack frames.
+	BcVec memo_calls;
+	BcVec memo_key;
 #endif // BC_ENABLED
 
 #if DC_ENABLED
@@ -90,6 +99,10 @@ typedef struct BcProgram {
 
 	BcDig one_num[BC_PROG_ONE_CAP];
 
+	// Whether the stack depth and operand types have to be checked in the
+	// frame that is running; this is false when the verifier proved them.
+	bool checks;
+
 } BcProgram;
 
 #define BC_PROG_STACK(s, n) ((s)->len >= ((size_t) (n)))
@@ -131,6 +144,37 @@ typedef struct BcProgram {
 	bc_program_pushArray(p, code, bgn)
 #endif // BC_ENABLED
 
+// Operators that have a fast path for integers of one limb.
+#define BC_PROG_SMALL_OP(i) \
+	((i) == BC_INST_MULTIPLY || (i) == BC_INST_PLUS || (i) == BC_INST_MINUS)
+
+// Operands that can be pushed between a multiply and an add that are fused.
+#define BC_PROG_FMA_OPD(i) \
+	((uchar) (i) == BC_INST_NUM || (uchar) (i) == BC_INST_VAR || \
+	 (uchar) (i) == BC_INST_ONE)
+
+// What the verifier knows about a result. A register is a dc variable or
+// array element, which may hold a string but can be assigned anything.
+typedef enum BcProgramType {
+
+	BC_PROG_TYPE_NUM,
+	BC_PROG_TYPE_STR,
+#if BC_ENABLED
+	BC_PROG_TYPE_ARRAY,
+#endif // BC_ENABLED
+#if DC_ENABLED
+	BC_PROG_TYPE_REG,
+	BC_PROG_TYPE_ANY,
+#endif // DC_ENABLED
+
+} BcProgramType;
+
+#define BC_PROG_TYPE(v, i) (*((uchar*) bc_vec_item_rev((v), (i))))
+
+// The depths that the verifier gives code that it has not reached yet.
+#define BC_PROG_DEPTH_NONE (SIZE_MAX)
+#define BC_PROG_DEPTH_LABEL (SIZE_MAX - 1)
+
 typedef void (*BcProgramUnary)(BcResult*, BcNum*);
 
 void bc_program_init(BcProgram *p);
@@ -148,6 +192,9 @@ BcStatus bc_program_printStackDebug(BcProgram* p);
 size_t bc_program_search(BcProgram *p, char* id, bool var);
 void bc_program_addFunc(BcProgram *p, BcFunc *f, const char* name);
 size_t bc_program_insertFunc(BcProgram *p, char *name);
+#if BC_ENABLED
+void bc_program_libSeries(BcProgram *p);
+#endif // BC_ENABLED
 BcStatus bc_program_reset(BcProgram *p, BcStatus s);
 BcStatus bc_program_exec(BcProgram *p);
 
@@ -168,5 +215,8 @@ extern const size_t bc_program_ready_msg_len;
 #endif // BC_ENABLE_SIGNALS
 extern const char bc_program_esc_chars[];
 extern const char bc_program_esc_seqs[];
+#if BC_ENABLED
+extern const char bc_program_series_fns[];
+#endif // BC_ENABLED
 
 #endif // BC_PROGRAM_H
@@ -73,13 +73,24 @@ void bc_vec_string(BcVec *restrict v, size_t len, const char *restrict str);
 void bc_vec_concat(BcVec *restrict v, const char *restrict str);
 void bc_vec_empty(BcVec *restrict v);
 
-#if BC_ENABLE_HISTORY
 void bc_vec_popAt(BcVec *restrict v, size_t idx);
+#if BC_ENABLE_HISTORY
 void bc_vec_replaceAt(BcVec *restrict v, size_t idx, const void *data);
 #endif // BC_ENABLE_HISTORY
 
+#ifndef NDEBUG
 void* bc_vec_item(const BcVec *restrict v, size_t idx);
 void* bc_vec_item_rev(const BcVec *restrict v, size_t idx);
+#else // NDEBUG
+// Without the asserts, these are too small to be worth a call, and the results
+// stack and variable stacks use them several times per instruction.
+#define BC_VEC(vec) ((const BcVec*) (vec))
+#define bc_vec_item(vec, idx) \
+	((void*) (BC_VEC(vec)->v + BC_VEC(vec)->size * (idx)))
+#define bc_vec_item_rev(vec, idx) \
+	((void*) (BC_VEC(vec)->v + \
+	          BC_VEC(vec)->size * (BC_VEC(vec)->len - (idx) - 1)))
+#endif // NDEBUG
 
 void bc_vec_free(void *vec);
 
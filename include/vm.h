@@ -51,6 +51,20 @@
 
 #endif // BC_ENABLE_NLS
 
+#ifndef BC_ENABLE_THREADS
+#define BC_ENABLE_THREADS (0)
+#endif // BC_ENABLE_THREADS
+
+#if BC_ENABLE_THREADS
+
+#	ifdef _WIN32
+#	error Threads are not supported on Windows.
+#	endif // _WIN32
+
+#include <pthread.h>
+
+#endif // BC_ENABLE_THREADS
+
 #include <status.h>
 #include <num.h>
 #include <parse.h>
@@ -103,6 +117,7 @@
 #define BC_FLAG_G (UINTMAX_C(1)<<6)
 #define BC_FLAG_P (UINTMAX_C(1)<<7)
 #define BC_FLAG_TTYIN (UINTMAX_C(1)<<8)
+#define BC_FLAG_M (UINTMAX_C(1)<<9)
 #define BC_TTYIN (vm->flags & BC_FLAG_TTYIN)
 #define BC_TTY (vm->tty)
 
@@ -113,6 +128,7 @@
 #define BC_G (BC_ENABLED && (vm->flags & BC_FLAG_G))
 #define DC_X (DC_ENABLED && (vm->flags & DC_FLAG_X))
 #define BC_P (vm->flags & BC_FLAG_P)
+#define BC_M (BC_ENABLED && (vm->flags & BC_FLAG_M))
 
 #define BC_USE_PROMPT (!BC_P && BC_TTY && !BC_IS_POSIX)
 
@@ -155,6 +171,45 @@
 
 #define BC_VM_INVALID_CATALOG ((nl_catd) -1)
 
+// The most threads, including the main one, that can be asked for.
+#define BC_VM_MAX_THREADS (256)
+
+// How much output is gathered before it is handed to the writer thread.
+#define BC_VM_OUT_SIZE (1 << 16)
+
+typedef BcStatus (*BcVmTaskFunc)(void*);
+
+#if BC_ENABLE_THREADS
+
+typedef struct BcVmTask {
+	pthread_t thread;
+	BcVmTaskFunc f;
+	void *data;
+	BcStatus s;
+	bool spawned;
+} BcVmTask;
+
+// Whether there are any threads to spawn at all. Work that only pays off when
+// it can be split between threads checks this first.
+#define BC_VM_THREADED (vm->max_threads != 0)
+
+#define BC_VM_MAIN_THREAD (pthread_equal(pthread_self(), vm->main_thread))
+
+#else // BC_ENABLE_THREADS
+
+typedef struct BcVmTask {
+	BcStatus s;
+} BcVmTask;
+
+#define BC_VM_THREADED (0)
+#define BC_VM_MAIN_THREAD (1)
+
+// Without threads, a task just runs to completion when it is spawned.
+#define bc_vm_spawn(t, f, d) ((void) ((t)->s = (f)(d)))
+#define bc_vm_join(t) ((t)->s)
+
+#endif // BC_ENABLE_THREADS
+
 typedef struct BcVm {
 
 	BcParse prs;
@@ -205,6 +260,36 @@ typedef struct BcVm {
 	BcBigDig last_exp;
 	BcBigDig last_rem;
 
+	// Long divisors that were seen recently, with their Barrett reciprocals
+	// once they were used again. Only the main thread uses these.
+	BcNumRecip recips[BC_NUM_RECIP_CACHE];
+	size_t recip_idx;
+
+	// Digit arrays of the default size that were freed, so that temporaries,
+	// which are mostly small, do not each have to be allocated. Only the main
+	// thread uses these.
+	BcDig *pool[BC_NUM_POOL];
+	size_t pool_len;
+
+#if BC_ENABLE_THREADS
+	pthread_t main_thread;
+	pthread_mutex_t thread_lock;
+	size_t threads;
+	size_t max_threads;
+
+	// When stdout is not a terminal and threads are allowed, output goes into
+	// one buffer while the writer thread writes the other one.
+	BcVec out[2];
+	pthread_t writer;
+	pthread_mutex_t out_lock;
+	pthread_cond_t out_cond;
+	uchar out_idx;
+	bool out_thread;
+	bool out_full;
+	bool out_done;
+	bool out_err;
+#endif // BC_ENABLE_THREADS
+
 #if BC_ENABLE_NLS
 	nl_catd catalog;
 #endif // BC_ENABLE_NLS
@@ -217,9 +302,15 @@ BcStatus bc_vm_posixError(BcError e, size_t line, ...);
 
 void bc_vm_info(const char* const help);
 BcStatus bc_vm_boot(int argc, char *argv[], const char *env_len,
-                    const char* const env_args, const char* env_exp_quit);
+                    const char* const env_args, const char* env_exp_quit,
+                    const char *env_threads);
 void bc_vm_shutdown(void);
 
+#if BC_ENABLE_THREADS
+void bc_vm_spawn(BcVmTask *t, BcVmTaskFunc f, void *data);
+BcStatus bc_vm_join(BcVmTask *t);
+#endif // BC_ENABLE_THREADS
+
 size_t bc_vm_printf(const char *fmt, ...);
 void bc_vm_puts(const char *str, FILE *restrict f);
 void bc_vm_putchar(int c);
@@ -57,6 +57,7 @@ static const struct option bc_args_lopt[] = {
 #if BC_ENABLED
 	{ "global-stacks", no_argument, NULL, 'g' },
 	{ "mathlib", no_argument, NULL, 'l' },
+	{ "memoize", no_argument, NULL, 'm' },
 	{ "quiet", no_argument, NULL, 'q' },
 	{ "standard", no_argument, NULL, 's' },
 	{ "warn", no_argument, NULL, 'w' },
@@ -72,9 +73,9 @@ static const struct option bc_args_lopt[] = {
 #if !BC_ENABLED
 static const char* const bc_args_opt = "e:f:hiPvVx";
 #elif !DC_ENABLED
-static const char* const bc_args_opt = "e:f:ghilPqsvVw";
+static const char* const bc_args_opt = "e:f:ghilmPqsvVw";
 #else // BC_ENABLED && DC_ENABLED
-static const char* const bc_args_opt = "e:f:ghilPqsvVwx";
+static const char* const bc_args_opt = "e:f:ghilmPqsvVwx";
 #endif // BC_ENABLED && DC_ENABLED
 
 static void bc_args_exprs(BcVec *exprs, const char *str) {
@@ -163,6 +164,13 @@ BcStatus bc_args(int argc, char *argv[]) {
 				break;
 			}
 
+			case 'm':
+			{
+				if (BC_ERR(!BC_IS_BC)) err = c;
+				vm->flags |= BC_FLAG_M;
+				break;
+			}
+
 			case 'q':
 			{
 				if (BC_ERR(!BC_IS_BC)) err = c;
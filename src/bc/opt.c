@@ -0,0 +1,862 @@
+/*
+ * *****************************************************************************
+ *
+ * Copyright (c) 2018-2019 Gavin D. Howard and contributors.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *****************************************************************************
+ *
+ * The optimizer for bc loops.
+ *
+ * Once the outermost loop of a function (or of the main code) is parsed, its
+ * code is simulated on a stack of expression trees. A subexpression that only
+ * reads variables, constants, and the globals, and is expensive enough, is
+ * then cached in a hidden array:
+ *
+ *   1. If no variable it reads is assigned in a loop around it, and that loop
+ *      has no barrier, it is computed the first time it is needed after the
+ *      loop is entered and reused until the loop is left.
+ *   2. Otherwise, if it appears more than once in a statement that does not
+ *      assign the variables it reads or have a barrier, it is computed once
+ *      per execution of that statement.
+ *
+ * Calls, read(), and assignments to ibase, obase, or scale are barriers
+ * because they can change anything that an expression depends on, including
+ * how constants are parsed and how precise the results are.
+ *
+ * Values are computed where they were in the original code, so an expression
+ * that would fail is never evaluated earlier than it was written. The code
+ * for a cached expression becomes:
+ *
+ *   CACHE slot skip, <expression>, CACHE_SAVE slot, skip:
+ *
+ * and the slots are cleared with CACHE_CLEAR when their loop is entered or
+ * their statement starts.
+ *
+ */
+
+#if BC_ENABLED
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <lang.h>
+#include <bc.h>
+#include <program.h>
+#include <vm.h>
+
+// How the simulation of the code sees an instruction boundary.
+#define BC_OPT_INSIDE (0)
+#define BC_OPT_INST (1)
+#define BC_OPT_STMT (2)
+
+#define BC_OPT_NONE (SIZE_MAX)
+
+typedef struct BcOptNode {
+	size_t bgn;
+	size_t end;
+	size_t stmt;
+	size_t ops;
+	size_t group;
+	size_t label;
+	bool pure;
+	bool costly;
+} BcOptNode;
+
+typedef struct BcOptRange {
+	size_t bgn;
+	size_t end;
+	size_t after;
+	bool barrier;
+} BcOptRange;
+
+typedef struct BcOptGroup {
+	size_t node;
+	size_t loop;
+	size_t stmt;
+	size_t arr;
+} BcOptGroup;
+
+typedef struct BcOpt {
+
+	BcParse *p;
+	BcFunc *f;
+	size_t bgn;
+	size_t end;
+
+	BcVec marks;
+	BcVec nodes;
+	BcVec stack;
+	BcVec assigns;
+	BcVec barriers;
+	BcVec stmts;
+	BcVec loops;
+	BcVec groups;
+	BcVec out;
+	BcVec map;
+
+} BcOpt;
+
+static size_t bc_opt_index(const char *code, size_t *bgn) {
+
+	uchar amt = (uchar) code[(*bgn)++], i = 0;
+	size_t res = 0;
+
+	for (; i < amt; ++i, ++(*bgn))
+		res |= ((size_t) (uchar) code[*bgn]) << (i * CHAR_BIT);
+
+	return res;
+}
+
+static BcOptNode* bc_opt_node(const BcOpt *o, size_t idx) {
+	return bc_vec_item(&o->nodes, idx);
+}
+
+static void bc_opt_push(BcOpt *o, size_t bgn, size_t end, bool pure) {
+
+	BcOptNode n;
+	size_t idx = o->nodes.len;
+
+	n.bgn = bgn;
+	n.end = end;
+	n.stmt = o->stmts.len - 1;
+	n.ops = 0;
+	n.group = BC_OPT_NONE;
+	n.label = BC_OPT_NONE;
+	n.pure = pure;
+	n.costly = false;
+
+	bc_vec_push(&o->nodes, &n);
+	bc_vec_push(&o->stack, &idx);
+}
+
+static bool bc_opt_pop(BcOpt *o, BcOptNode *n) {
+
+	if (!o->stack.len) return false;
+
+	memcpy(n, bc_opt_node(o, *((size_t*) bc_vec_top(&o->stack))),
+	       sizeof(BcOptNode));
+	bc_vec_pop(&o->stack);
+
+	return true;
+}
+
+static bool bc_opt_costly(uchar inst) {
+	return inst == BC_INST_POWER || inst == BC_INST_MULTIPLY ||
+	       inst == BC_INST_DIVIDE || inst == BC_INST_MODULUS ||
+#if BC_ENABLE_EXTRA_MATH
+	       inst == BC_INST_PLACES || inst == BC_INST_LSHIFT ||
+	       inst == BC_INST_RSHIFT ||
+#endif // BC_ENABLE_EXTRA_MATH
+	       inst == BC_INST_SQRT;
+}
+
+// Records what an assignment writes: variables are remembered with where they
+// are assigned, and the globals are barriers. Array elements do not matter
+// because expressions that read arrays are never cached.
+static void bc_opt_assign(BcOpt *o, const BcOptNode *n, size_t i) {
+
+	const char *code = o->f->code.v;
+	uchar inst = (uchar) code[n->bgn];
+	size_t idx = n->bgn + 1;
+	BcLoc a;
+
+	if (inst == BC_INST_VAR) {
+		a.loc = i;
+		a.idx = bc_opt_index(code, &idx);
+		bc_vec_push(&o->assigns, &a);
+	}
+	else if (inst >= BC_INST_IBASE && inst <= BC_INST_SCALE)
+		bc_vec_push(&o->barriers, &i);
+}
+
+// Simulates the code, building a tree node for every value that is pushed.
+// This returns false if the code is not what the parser would generate, in
+// which case nothing is changed.
+static bool bc_opt_scan(BcOpt *o) {
+
+	const char *code = o->f->code.v;
+	size_t i = o->bgn, j, n;
+	uchar mark = BC_OPT_INSIDE;
+	BcOptNode a, b;
+	BcOptRange r;
+
+	for (j = o->bgn; j <= o->end; ++j) bc_vec_push(&o->marks, &mark);
+
+	r.end = r.after = BC_OPT_NONE;
+	r.barrier = false;
+
+	while (i < o->end) {
+
+		size_t start = i;
+		uchar inst = (uchar) code[i++];
+
+		mark = o->stack.len ? BC_OPT_INST : BC_OPT_STMT;
+		*((uchar*) bc_vec_item(&o->marks, start - o->bgn)) = mark;
+
+		if (mark == BC_OPT_STMT) {
+			if (o->stmts.len) {
+				BcOptRange *prev = bc_vec_top(&o->stmts);
+				prev->end = start;
+			}
+			r.bgn = start;
+			bc_vec_push(&o->stmts, &r);
+		}
+
+		switch (inst) {
+
+			case BC_INST_NUM:
+			case BC_INST_VAR:
+			{
+				bc_opt_index(code, &i);
+				bc_opt_push(o, start, i, true);
+				break;
+			}
+
+			case BC_INST_ONE:
+			case BC_INST_IBASE:
+			case BC_INST_OBASE:
+			case BC_INST_SCALE:
+			case BC_INST_MAXIBASE:
+			case BC_INST_MAXOBASE:
+			case BC_INST_MAXSCALE:
+			{
+				bc_opt_push(o, start, i, true);
+				break;
+			}
+
+			case BC_INST_ARRAY:
+			case BC_INST_STR:
+			{
+				bc_opt_index(code, &i);
+				bc_opt_push(o, start, i, false);
+				break;
+			}
+
+			case BC_INST_READ:
+			{
+				bc_vec_push(&o->barriers, &start);
+			}
+			// Fallthrough.
+			case BC_INST_LAST:
+			{
+				bc_opt_push(o, start, i, false);
+				break;
+			}
+
+			case BC_INST_ARRAY_ELEM:
+			{
+				bc_opt_index(code, &i);
+				if (!bc_opt_pop(o, &a)) return false;
+				bc_opt_push(o, a.bgn, i, false);
+				break;
+			}
+
+			case BC_INST_NEG:
+			case BC_INST_BOOL_NOT:
+#if BC_ENABLE_EXTRA_MATH
+			case BC_INST_TRUNC:
+#endif // BC_ENABLE_EXTRA_MATH
+			case BC_INST_LENGTH:
+			case BC_INST_SCALE_FUNC:
+			case BC_INST_SQRT:
+			case BC_INST_ABS:
+			{
+				BcOptNode *top;
+
+				if (!bc_opt_pop(o, &a)) return false;
+
+				bc_opt_push(o, a.bgn, i, a.pure);
+
+				top = bc_vec_top(&o->nodes);
+				top->ops = a.ops + 1;
+				top->costly = a.costly || bc_opt_costly(inst);
+
+				break;
+			}
+
+			case BC_INST_POWER:
+			case BC_INST_MULTIPLY:
+			case BC_INST_DIVIDE:
+			case BC_INST_MODULUS:
+			case BC_INST_PLUS:
+			case BC_INST_MINUS:
+#if BC_ENABLE_EXTRA_MATH
+			case BC_INST_PLACES:
+			case BC_INST_LSHIFT:
+			case BC_INST_RSHIFT:
+#endif // BC_ENABLE_EXTRA_MATH
+			case BC_INST_REL_EQ:
+			case BC_INST_REL_LE:
+			case BC_INST_REL_GE:
+			case BC_INST_REL_NE:
+			case BC_INST_REL_LT:
+			case BC_INST_REL_GT:
+			case BC_INST_BOOL_OR:
+			case BC_INST_BOOL_AND:
+			{
+				BcOptNode *top;
+
+				if (!bc_opt_pop(o, &b) || !bc_opt_pop(o, &a)) return false;
+
+				bc_opt_push(o, a.bgn, i, a.pure && b.pure);
+
+				top = bc_vec_top(&o->nodes);
+				top->ops = a.ops + b.ops + 1;
+				top->costly = a.costly || b.costly || bc_opt_costly(inst);
+
+				break;
+			}
+
+			case BC_INST_INC_POST:
+			case BC_INST_DEC_POST:
+			case BC_INST_INC_PRE:
+			case BC_INST_DEC_PRE:
+			{
+				if (!bc_opt_pop(o, &a)) return false;
+				bc_opt_assign(o, &a, start);
+				bc_opt_push(o, a.bgn, i, false);
+				break;
+			}
+
+			case BC_INST_INC_NO_VAL:
+			case BC_INST_DEC_NO_VAL:
+			{
+				if (!bc_opt_pop(o, &a)) return false;
+				bc_opt_assign(o, &a, start);
+				break;
+			}
+
+			case BC_INST_ASSIGN_POWER:
+			case BC_INST_ASSIGN_MULTIPLY:
+			case BC_INST_ASSIGN_DIVIDE:
+			case BC_INST_ASSIGN_MODULUS:
+			case BC_INST_ASSIGN_PLUS:
+			case BC_INST_ASSIGN_MINUS:
+#if BC_ENABLE_EXTRA_MATH
+			case BC_INST_ASSIGN_PLACES:
+			case BC_INST_ASSIGN_LSHIFT:
+			case BC_INST_ASSIGN_RSHIFT:
+#endif // BC_ENABLE_EXTRA_MATH
+			case BC_INST_ASSIGN:
+			{
+				if (!bc_opt_pop(o, &b) || !bc_opt_pop(o, &a)) return false;
+				bc_opt_assign(o, &a, start);
+				bc_opt_push(o, a.bgn, i, false);
+				break;
+			}
+
+			case BC_INST_ASSIGN_POWER_NO_VAL:
+			case BC_INST_ASSIGN_MULTIPLY_NO_VAL:
+			case BC_INST_ASSIGN_DIVIDE_NO_VAL:
+			case BC_INST_ASSIGN_MODULUS_NO_VAL:
+			case BC_INST_ASSIGN_PLUS_NO_VAL:
+			case BC_INST_ASSIGN_MINUS_NO_VAL:
+#if BC_ENABLE_EXTRA_MATH
+			case BC_INST_ASSIGN_PLACES_NO_VAL:
+			case BC_INST_ASSIGN_LSHIFT_NO_VAL:
+			case BC_INST_ASSIGN_RSHIFT_NO_VAL:
+#endif // BC_ENABLE_EXTRA_MATH
+			case BC_INST_ASSIGN_NO_VAL:
+			{
+				if (!bc_opt_pop(o, &b) || !bc_opt_pop(o, &a)) return false;
+				bc_opt_assign(o, &a, start);
+				break;
+			}
+
+			case BC_INST_JUMP_ZERO:
+			{
+				bc_opt_index(code, &i);
+			}
+			// Fallthrough.
+			case BC_INST_PRINT:
+			case BC_INST_PRINT_POP:
+			case BC_INST_PRINT_STR:
+			case BC_INST_POP:
+			case BC_INST_RET:
+			{
+				if (!bc_opt_pop(o, &a)) return false;
+				break;
+			}
+
+			case BC_INST_JUMP:
+			{
+				bc_opt_index(code, &i);
+				break;
+			}
+
+			case BC_INST_GLOBAL_SAVE:
+			{
+				BcLoc v;
+
+				bc_opt_index(code, &i);
+
+				v.loc = start;
+				v.idx = bc_opt_index(code, &i);
+				bc_vec_push(&o->assigns, &v);
+
+				break;
+			}
+
+			case BC_INST_GLOBAL_RESTORE:
+			case BC_INST_GLOBAL_SET:
+			{
+				bc_opt_index(code, &i);
+				bc_opt_index(code, &i);
+				bc_vec_push(&o->barriers, &start);
+				break;
+			}
+
+			case BC_INST_RET0:
+			case BC_INST_RET_VOID:
+			case BC_INST_HALT:
+			{
+				break;
+			}
+
+			case BC_INST_CALL:
+			{
+				size_t first = start;
+
+				n = bc_opt_index(code, &i);
+				bc_opt_index(code, &i);
+
+				for (j = 0; j < n; ++j) {
+					if (!bc_opt_pop(o, &a)) return false;
+					first = a.bgn;
+				}
+
+				bc_vec_push(&o->barriers, &start);
+				bc_opt_push(o, first, i, false);
+
+				break;
+			}
+
+			default:
+			{
+				return false;
+			}
+		}
+	}
+
+	if (i != o->end || o->stack.len || !o->stmts.len) return false;
+
+	((BcOptRange*) bc_vec_top(&o->stmts))->end = o->end;
+
+	// Jumps may only land between statements because that is where the
+	// slots of statements are cleared.
+	for (i = 0; i < o->f->labels.len; ++i) {
+
+		size_t addr = *((size_t*) bc_vec_item(&o->f->labels, i));
+
+		if (addr < o->bgn || addr >= o->end) continue;
+
+		mark = *((uchar*) bc_vec_item(&o->marks, addr - o->bgn));
+		if (mark != BC_OPT_STMT) return false;
+	}
+
+	return true;
+}
+
+static bool bc_opt_barrier(const BcOpt *o, size_t bgn, size_t end) {
+
+	size_t i;
+
+	for (i = 0; i < o->barriers.len; ++i) {
+		size_t addr = *((size_t*) bc_vec_item(&o->barriers, i));
+		if (addr >= bgn && addr < end) return true;
+	}
+
+	return false;
+}
+
+// Returns true if a variable that is read by the node is assigned between bgn
+// and end.
+static bool bc_opt_assigned(const BcOpt *o, const BcOptNode *n,
+                            size_t bgn, size_t end)
+{
+	const char *code = o->f->code.v;
+	size_t i = n->bgn, j;
+
+	while (i < n->end) {
+
+		uchar inst = (uchar) code[i++];
+		size_t idx;
+
+		if (inst != BC_INST_VAR && inst != BC_INST_NUM) continue;
+
+		idx = bc_opt_index(code, &i);
+
+		if (inst != BC_INST_VAR) continue;
+
+		for (j = 0; j < o->assigns.len; ++j) {
+			BcLoc *a = bc_vec_item(&o->assigns, j);
+			if (a->idx == idx && a->loc >= bgn && a->loc < end) return true;
+		}
+	}
+
+	return false;
+}
+
+static bool bc_opt_equal(const BcOpt *o, const BcOptNode *a,
+                         const BcOptNode *b)
+{
+	const char *code = o->f->code.v;
+	size_t i = a->bgn, j = b->bgn;
+
+	while (i < a->end && j < b->end) {
+
+		uchar inst = (uchar) code[i++];
+		size_t x, y;
+
+		if (inst != (uchar) code[j++]) return false;
+		if (inst != BC_INST_VAR && inst != BC_INST_NUM) continue;
+
+		x = bc_opt_index(code, &i);
+		y = bc_opt_index(code, &j);
+
+		if (inst == BC_INST_NUM) {
+			BcConst *c1 = bc_vec_item(&o->f->consts, x);
+			BcConst *c2 = bc_vec_item(&o->f->consts, y);
+			if (strcmp(c1->val, c2->val)) return false;
+		}
+		else if (x != y) return false;
+	}
+
+	return i == a->end && j == b->end;
+}
+
+// Returns true if the node overlaps one that is already cached.
+static bool bc_opt_taken(const BcOpt *o, const BcOptNode *n) {
+
+	size_t i;
+
+	for (i = 0; i < o->nodes.len; ++i) {
+		BcOptNode *m = bc_opt_node(o, i);
+		if (m->group != BC_OPT_NONE && m->bgn < n->end && n->bgn < m->end)
+			return true;
+	}
+
+	return false;
+}
+
+static void bc_opt_group(BcOpt *o, size_t node, size_t loop, size_t stmt) {
+
+	BcOptGroup g;
+
+	g.node = node;
+	g.loop = loop;
+	g.stmt = stmt;
+	g.arr = BC_OPT_NONE;
+
+	bc_opt_node(o, node)->group = o->groups.len;
+	bc_vec_push(&o->groups, &g);
+}
+
+static void bc_opt_choose(BcOpt *o) {
+
+	size_t i = o->nodes.len, j, k;
+
+	// Going backwards visits outer expressions before the ones inside them,
+	// and the outer ones save more.
+	while (i--) {
+
+		BcOptNode *n = bc_opt_node(o, i);
+		BcOptRange *s;
+		size_t loop = BC_OPT_NONE;
+		bool found = false;
+
+		if (!n->pure || (!n->costly && n->ops < 2) || bc_opt_taken(o, n))
+			continue;
+
+		// The loop that the node can be hoisted out of is the outermost one
+		// that contains it and does not change it.
+		for (j = 0; j < o->loops.len; ++j) {
+
+			BcOptRange *l = bc_vec_item(&o->loops, j);
+
+			if (n->bgn < l->bgn || n->end > l->end || l->barrier) continue;
+			if (loop != BC_OPT_NONE &&
+			    ((BcOptRange*) bc_vec_item(&o->loops, loop))->bgn < l->bgn)
+			{
+				continue;
+			}
+			if (bc_opt_assigned(o, n, l->bgn, l->end)) continue;
+
+			loop = j;
+		}
+
+		if (loop != BC_OPT_NONE) {
+
+			for (k = 0; !found && k < o->groups.len; ++k) {
+
+				BcOptGroup *g = bc_vec_item(&o->groups, k);
+
+				found = (g->loop == loop &&
+				         bc_opt_equal(o, n, bc_opt_node(o, g->node)));
+
+				if (found) n->group = k;
+			}
+
+			if (!found) bc_opt_group(o, i, loop, BC_OPT_NONE);
+
+			continue;
+		}
+
+		s = bc_vec_item(&o->stmts, n->stmt);
+
+		if (s->barrier || bc_opt_assigned(o, n, s->bgn, s->end)) continue;
+
+		for (j = 0; j < i; ++j) {
+
+			BcOptNode *m = bc_opt_node(o, j);
+
+			if (m->stmt != n->stmt || !m->pure || bc_opt_taken(o, m) ||
+			    !bc_opt_equal(o, n, m))
+			{
+				continue;
+			}
+
+			if (!found) bc_opt_group(o, i, BC_OPT_NONE, n->stmt);
+
+			m->group = o->groups.len - 1;
+			found = true;
+		}
+	}
+}
+
+// Gives each group a hidden array. The names cannot be written in bc code, so
+// they cannot clash with anything.
+static BcStatus bc_opt_slots(BcOpt *o) {
+
+	BcStatus s = BC_STATUS_SUCCESS;
+	BcProgram *prog = o->p->prog;
+	size_t i, j;
+
+	for (i = 0; BC_NO_ERR(!s) && i < o->groups.len; ++i) {
+
+		BcOptGroup *g = bc_vec_item(&o->groups, i);
+		char name[sizeof(size_t) * CHAR_BIT / 3 + 2];
+		bool found = false;
+
+		snprintf(name, sizeof(name), "%zu", i);
+
+		g->arr = bc_program_search(prog, name, false);
+
+		if (o->p->fidx == BC_PROG_MAIN) continue;
+
+		for (j = 0; !found && j < o->f->autos.len; ++j) {
+			BcLoc *a = bc_vec_item(&o->f->autos, j);
+			found = (a->loc == g->arr && a->idx == BC_TYPE_ARRAY);
+		}
+
+		if (!found)
+			s = bc_func_insert(o->f, prog, name, BC_TYPE_ARRAY, o->p->l.line);
+	}
+
+	return s;
+}
+
+static void bc_opt_emit(BcOpt *o, uchar inst, size_t idx) {
+	bc_vec_pushByte(&o->out, inst);
+	bc_vec_pushIndex(&o->out, idx);
+}
+
+static void bc_opt_clear(BcOpt *o, size_t loop, size_t stmt) {
+
+	size_t i;
+
+	for (i = 0; i < o->groups.len; ++i) {
+		BcOptGroup *g = bc_vec_item(&o->groups, i);
+		if (g->loop == loop && g->stmt == stmt)
+			bc_opt_emit(o, BC_INST_CACHE_CLEAR, g->arr);
+	}
+}
+
+// Emits what goes before the instruction at addr.
+static void bc_opt_insert(BcOpt *o, size_t addr) {
+
+	size_t i;
+
+	*((size_t*) bc_vec_item(&o->map, addr - o->bgn)) = o->out.len;
+
+	for (i = 0; i < o->loops.len; ++i) {
+
+		BcOptRange *l = bc_vec_item(&o->loops, i);
+
+		if (l->bgn != addr) continue;
+
+		bc_opt_clear(o, i, BC_OPT_NONE);
+		l->after = o->out.len;
+	}
+
+	for (i = 0; i < o->stmts.len; ++i) {
+		BcOptRange *s = bc_vec_item(&o->stmts, i);
+		if (s->bgn == addr) bc_opt_clear(o, BC_OPT_NONE, i);
+	}
+
+	for (i = 0; i < o->nodes.len; ++i) {
+
+		BcOptNode *n = bc_opt_node(o, i);
+		BcOptGroup *g;
+		size_t *label;
+
+		if (n->group == BC_OPT_NONE || n->end != addr) continue;
+
+		g = bc_vec_item(&o->groups, n->group);
+		bc_opt_emit(o, BC_INST_CACHE_SAVE, g->arr);
+
+		label = bc_vec_item(&o->f->labels, n->label);
+		*label = o->bgn + o->out.len;
+	}
+
+	for (i = 0; i < o->nodes.len; ++i) {
+
+		BcOptNode *n = bc_opt_node(o, i);
+		BcOptGroup *g;
+
+		if (n->group == BC_OPT_NONE || n->bgn != addr) continue;
+
+		g = bc_vec_item(&o->groups, n->group);
+		bc_opt_emit(o, BC_INST_CACHE, g->arr);
+		bc_vec_pushIndex(&o->out, n->label);
+	}
+}
+
+static void bc_opt_rewrite(BcOpt *o) {
+
+	const char *code;
+	size_t i, len = o->f->labels.len, none = BC_OPT_NONE;
+
+	for (i = 0; i < o->nodes.len; ++i) {
+		BcOptNode *n = bc_opt_node(o, i);
+		if (n->group == BC_OPT_NONE) continue;
+		n->label = o->f->labels.len;
+		bc_vec_push(&o->f->labels, &none);
+	}
+
+	for (i = o->bgn; i <= o->end; ++i) bc_vec_push(&o->map, &none);
+
+	code = o->f->code.v;
+
+	for (i = o->bgn; i < o->end; ++i) {
+
+		uchar mark = *((uchar*) bc_vec_item(&o->marks, i - o->bgn));
+
+		if (mark != BC_OPT_INSIDE) bc_opt_insert(o, i);
+
+		bc_vec_pushByte(&o->out, (uchar) code[i]);
+	}
+
+	bc_opt_insert(o, o->end);
+
+	for (i = 0; i < len; ++i) {
+
+		size_t *label = bc_vec_item(&o->f->labels, i);
+
+		if (*label < o->bgn || *label > o->end) continue;
+
+		*label = o->bgn + *((size_t*) bc_vec_item(&o->map, *label - o->bgn));
+	}
+
+	// Jumping back to the condition of a loop must not clear its slots.
+	for (i = 0; i < o->p->loops.len; ++i) {
+
+		BcParseLoop *pl = bc_vec_item(&o->p->loops, i);
+		BcOptRange *l = bc_vec_item(&o->loops, i);
+		size_t *label = bc_vec_item(&o->f->labels, pl->label);
+
+		*label = o->bgn + l->after;
+	}
+
+	bc_vec_npop(&o->f->code, o->f->code.len - o->bgn);
+	bc_vec_npush(&o->f->code, o->out.len, o->out.v);
+}
+
+void bc_opt_loops(BcParse *p) {
+
+	BcOpt o;
+	BcParseLoop *outer = bc_vec_item(&p->loops, 0);
+	size_t i;
+
+	o.p = p;
+	o.f = p->func;
+	o.bgn = outer->bgn;
+	o.end = outer->end;
+
+	assert(o.end == o.f->code.len);
+
+	bc_vec_init(&o.marks, sizeof(uchar), NULL);
+	bc_vec_init(&o.nodes, sizeof(BcOptNode), NULL);
+	bc_vec_init(&o.stack, sizeof(size_t), NULL);
+	bc_vec_init(&o.assigns, sizeof(BcLoc), NULL);
+	bc_vec_init(&o.barriers, sizeof(size_t), NULL);
+	bc_vec_init(&o.stmts, sizeof(BcOptRange), NULL);
+	bc_vec_init(&o.loops, sizeof(BcOptRange), NULL);
+	bc_vec_init(&o.groups, sizeof(BcOptGroup), NULL);
+	bc_vec_init(&o.out, sizeof(uchar), NULL);
+	bc_vec_init(&o.map, sizeof(size_t), NULL);
+
+	if (!bc_opt_scan(&o)) goto err;
+
+	for (i = 0; i < o.stmts.len; ++i) {
+		BcOptRange *s = bc_vec_item(&o.stmts, i);
+		s->barrier = bc_opt_barrier(&o, s->bgn, s->end);
+	}
+
+	for (i = 0; i < p->loops.len; ++i) {
+
+		BcParseLoop *pl = bc_vec_item(&p->loops, i);
+		BcOptRange l;
+
+		l.bgn = pl->bgn;
+		l.end = pl->end;
+		l.after = BC_OPT_NONE;
+		l.barrier = bc_opt_barrier(&o, l.bgn, l.end);
+
+		bc_vec_push(&o.loops, &l);
+	}
+
+	bc_opt_choose(&o);
+
+	if (o.groups.len && BC_NO_ERR(!bc_opt_slots(&o))) bc_opt_rewrite(&o);
+
+err:
+	bc_vec_free(&o.map);
+	bc_vec_free(&o.out);
+	bc_vec_free(&o.groups);
+	bc_vec_free(&o.loops);
+	bc_vec_free(&o.stmts);
+	bc_vec_free(&o.barriers);
+	bc_vec_free(&o.assigns);
+	bc_vec_free(&o.stack);
+	bc_vec_free(&o.nodes);
+	bc_vec_free(&o.marks);
+}
+
+#endif // BC_ENABLED
@@ -117,6 +117,36 @@ static void bc_parse_createCondLabel(BcParse *p, size_t idx) {
 	bc_vec_push(&p->conds, &idx);
 }
 
+static void bc_parse_startLoop(BcParse *p, size_t label) {
+
+	BcParseLoop loop;
+
+	loop.label = label;
+	loop.bgn = p->func->code.len;
+	loop.end = SIZE_MAX;
+
+	bc_vec_push(&p->loops, &loop);
+}
+
+// Once the outermost loop is finished, none of its code can change anymore, so
+// that is when it is optimized.
+static void bc_parse_endLoop(BcParse *p) {
+
+	size_t i = p->loops.len;
+	BcParseLoop *loop;
+
+	do {
+		loop = bc_vec_item(&p->loops, --i);
+	} while (loop->end != SIZE_MAX);
+
+	loop->end = p->func->code.len;
+
+	if (!i) {
+		bc_opt_loops(p);
+		bc_vec_npop(&p->loops, p->loops.len);
+	}
+}
+
 static void bc_parse_createExitLabel(BcParse *p, size_t idx, bool loop) {
 
 	BcInstPtr ip;
@@ -607,6 +637,8 @@ static BcStatus bc_parse_endBody(BcParse *p, bool brace) {
 
 			bc_parse_setLabel(p);
 			bc_vec_pop(&p->flags);
+
+			if (loop) bc_parse_endLoop(p);
 		}
 		else if (BC_PARSE_FUNC_INNER(p)) {
 			BcInst inst = (p->func->voidfn ? BC_INST_RET_VOID : BC_INST_RET0);
@@ -735,6 +767,7 @@ static BcStatus bc_parse_while(BcParse *p) {
 	s = bc_lex_next(&p->l);
 	if (BC_ERR(s)) return s;
 
+	bc_parse_startLoop(p, p->func->labels.len);
 	bc_parse_createCondLabel(p, p->func->labels.len);
 	idx = p->func->labels.len;
 	bc_parse_createExitLabel(p, idx, true);
@@ -780,6 +813,7 @@ static BcStatus bc_parse_for(BcParse *p) {
 	body_idx = update_idx + 1;
 	exit_idx = body_idx + 1;
 
+	bc_parse_startLoop(p, cond_idx);
 	bc_parse_createLabel(p, p->func->code.len);
 
 	if (p->l.t != BC_LEX_SCOLON) {
@@ -1255,13 +1289,52 @@ BcStatus bc_parse_parse(BcParse *p) {
 	return s;
 }
 
+// Turns a statement that assigns a global to a variable, or a variable or a
+// constant to a global, into one instruction. Functions save and restore ibase
+// and scale like this, so it makes calls to them cheaper.
+static void bc_parse_global(BcParse *p, size_t bgn) {
+
+	BcVec *code = &p->func->code;
+	uchar first = (uchar) code->v[bgn], last, inst;
+	char idx[sizeof(size_t) + 1];
+	size_t g, i = bgn + 1, len;
+
+	if (first == BC_INST_VAR) inst = BC_INST_GLOBAL_SAVE;
+	else if (BC_PARSE_INST_GLOBAL(first)) {
+
+		uchar second = (uchar) code->v[i++];
+
+		if (second == BC_INST_VAR) inst = BC_INST_GLOBAL_RESTORE;
+		else if (second == BC_INST_NUM) inst = BC_INST_GLOBAL_SET;
+		else return;
+	}
+	else return;
+
+	len = 1 + (uchar) code->v[i];
+	if (i + len + 1 + (first == BC_INST_VAR) != code->len) return;
+
+	if (first == BC_INST_VAR) {
+		last = (uchar) code->v[i + len];
+		if (!BC_PARSE_INST_GLOBAL(last)) return;
+		g = last - BC_INST_IBASE;
+	}
+	else g = first - BC_INST_IBASE;
+
+	memcpy(idx, code->v + i, len);
+	bc_vec_npop(code, code->len - bgn);
+
+	bc_parse_push(p, inst);
+	bc_parse_pushIndex(p, g);
+	bc_vec_npush(code, len, idx);
+}
+
 static BcStatus bc_parse_expr_err(BcParse *p, uint8_t flags, BcParseNext next) {
 
 	BcStatus s = BC_STATUS_SUCCESS;
 	BcInst prev = BC_INST_PRINT;
 	uchar inst = BC_INST_INVALID;
 	BcLexType top, t = p->l.t;
-	size_t nexprs = 0, ops_bgn = p->ops.len;
+	size_t nexprs = 0, ops_bgn = p->ops.len, code_bgn = p->func->code.len;
 	uint32_t i, nparens, nrelops;
 	bool pfirst, rprn, done, get_token, assign, bin_last, incdec, can_assign;
 
@@ -1563,6 +1636,7 @@ static BcStatus bc_parse_expr_err(BcParse *p, uint8_t flags, BcParseNext next) {
 		if (inst >= BC_INST_INC_NO_VAL && inst <= BC_INST_ASSIGN_NO_VAL) {
 			bc_vec_pop(&p->func->code);
 			bc_parse_push(p, inst);
+			if (inst == BC_INST_ASSIGN_NO_VAL) bc_parse_global(p, code_bgn);
 		}
 	}
 
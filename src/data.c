@@ -621,7 +621,15 @@ const char* bc_inst_names[] = {
 	"BC_INST_RET0",
 	"BC_INST_RET_VOID",
 
-	"BC_INST_HALT,"
+	"BC_INST_HALT",
+
+	"BC_INST_CACHE",
+	"BC_INST_CACHE_SAVE",
+	"BC_INST_CACHE_CLEAR",
+
+	"BC_INST_GLOBAL_SAVE",
+	"BC_INST_GLOBAL_RESTORE",
+	"BC_INST_GLOBAL_SET",
 #endif // BC_ENABLED
 
 #if DC_ENABLED
@@ -901,3 +909,8 @@ const size_t bc_program_ready_msg_len = sizeof(bc_program_ready_msg) - 1;
 #endif // BC_ENABLE_SIGNALS
 const char bc_program_esc_chars[] = "ab\\efnqrt";
 const char bc_program_esc_seqs[] = "\a\b\\\\\f\n\"\r\t";
+
+#if BC_ENABLED
+// The math library functions that bc_num_series() can evaluate.
+const char bc_program_series_fns[] = "ela";
+#endif // BC_ENABLED
@@ -56,7 +56,8 @@ int dc_main(int argc, char **argv) {
 	vm->parse = dc_parse_parse;
 	vm->expr = dc_parse_expr;
 
-	s = bc_vm_boot(argc, argv, "DC_LINE_LENGTH", "DC_ENV_ARGS", "DC_EXPR_EXIT");
+	s = bc_vm_boot(argc, argv, "DC_LINE_LENGTH", "DC_ENV_ARGS",
+	               "DC_EXPR_EXIT", "DC_THREADS");
 
 	return (int) s;
 }
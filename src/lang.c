@@ -44,18 +44,63 @@ int bc_id_cmp(const BcId *e1, const BcId *e2) {
 	return strcmp(e1->name, e2->name);
 }
 
-#ifndef NDEBUG
 void bc_id_free(void *id) {
 	assert(id != NULL);
 	free(((BcId*) id)->name);
 }
-#endif // NDEBUG
 
 void bc_string_free(void *string) {
 	assert(string != NULL && (*((char**) string)) != NULL);
 	free(*((char**) string));
 }
 
+void bc_str_init(BcStr *s, char *val) {
+
+	size_t i, j, len = strlen(val);
+	const char *nl;
+
+	s->val = s->esc = val;
+
+	if (strchr(val, '\\') != NULL) {
+
+		s->esc = bc_vm_malloc(len + 1);
+
+		for (i = 0, j = 0; i < len; ++i) {
+
+			char c = val[i];
+
+			if (c == '\\' && i != len - 1) {
+
+				const char *ptr;
+
+				c = val[++i];
+				ptr = strchr(bc_program_esc_chars, c);
+
+				// Unknown escapes print the backslash and the character.
+				if (ptr == NULL) s->esc[j++] = '\\';
+				else c = bc_program_esc_seqs[ptr - bc_program_esc_chars];
+			}
+
+			s->esc[j++] = c;
+		}
+
+		s->esc[j] = '\0';
+		len = j;
+	}
+
+	s->len = len;
+
+	nl = strrchr(s->esc, '\n');
+	s->col = nl != NULL ? strlen(nl + 1) : SIZE_MAX;
+}
+
+void bc_str_free(void *str) {
+	BcStr *s = str;
+	assert(s->val != NULL);
+	if (s->esc != s->val) free(s->esc);
+	free(s->val);
+}
+
 void bc_const_free(void *constant) {
 	BcConst *c = constant;
 	assert(c->val != NULL);
@@ -94,14 +139,19 @@ BcStatus bc_func_insert(BcFunc *f, BcProgram *p, char *name,
 void bc_func_init(BcFunc *f, const char *name) {
 	assert(f != NULL && name != NULL);
 	bc_vec_init(&f->code, sizeof(uchar), NULL);
-	bc_vec_init(&f->strs, sizeof(char*), bc_string_free);
+	bc_vec_init(&f->strs, sizeof(BcStr), bc_str_free);
 	bc_vec_init(&f->consts, sizeof(BcConst), bc_const_free);
+	f->verified = BC_FUNC_CHECK_UNKNOWN;
 #if BC_ENABLED
 	if (BC_IS_BC) {
 		bc_vec_init(&f->autos, sizeof(BcLoc), NULL);
 		bc_vec_init(&f->labels, sizeof(size_t), NULL);
 		f->nparams = 0;
 		f->voidfn = false;
+		f->series = 0;
+		bc_vec_init(&f->memo_map, sizeof(BcId), bc_id_free);
+		bc_vec_init(&f->memo, sizeof(BcNum), bc_num_free);
+		bc_func_forget(f);
 	}
 #endif // BC_ENABLED
 	f->name = name;
@@ -112,12 +162,15 @@ void bc_func_reset(BcFunc *f) {
 	bc_vec_npop(&f->code, f->code.len);
 	bc_vec_npop(&f->strs, f->strs.len);
 	bc_vec_npop(&f->consts, f->consts.len);
+	f->verified = BC_FUNC_CHECK_UNKNOWN;
 #if BC_ENABLED
 	if (BC_IS_BC) {
 		bc_vec_npop(&f->autos, f->autos.len);
 		bc_vec_npop(&f->labels, f->labels.len);
 		f->nparams = 0;
 		f->voidfn = false;
+		f->series = 0;
+		bc_func_forget(f);
 	}
 #endif // BC_ENABLED
 }
@@ -132,10 +185,26 @@ void bc_func_free(void *func) {
 	if (BC_IS_BC) {
 		bc_vec_free(&f->autos);
 		bc_vec_free(&f->labels);
+		bc_vec_free(&f->memo_map);
+		bc_vec_free(&f->memo);
 	}
 #endif // BC_ENABLED
 }
 
+#if BC_ENABLED
+void bc_func_forget(BcFunc *f) {
+	assert(f != NULL);
+	f->pure = BC_FUNC_CHECK_UNKNOWN;
+	bc_vec_npop(&f->memo_map, f->memo_map.len);
+	bc_vec_npop(&f->memo, f->memo.len);
+	f->memo_size = 0;
+	f->closed = BC_FUNC_CHECK_UNKNOWN;
+	f->fwd = BC_FUNC_CHECK_UNKNOWN;
+	f->fwd_func = 0;
+	f->globals = BC_FUNC_CHECK_UNKNOWN;
+}
+#endif // BC_ENABLED
+
 void bc_array_init(BcVec *a, bool nums) {
 	if (nums) bc_vec_init(a, sizeof(BcNum), bc_num_free);
 	else bc_vec_init(a, sizeof(BcVec), bc_vec_free);
@@ -182,7 +251,6 @@ void bc_array_expand(BcVec *a, size_t len) {
 	}
 }
 
-#if DC_ENABLED
 void bc_result_copy(BcResult *d, BcResult *src) {
 
 	assert(d != NULL && src != NULL);
@@ -217,6 +285,9 @@ void bc_result_copy(BcResult *d, BcResult *src) {
 			break;
 		}
 
+#if BC_ENABLED
+		case BC_RESULT_LAST:
+#endif // BC_ENABLED
 		case BC_RESULT_ONE:
 		{
 			// Do nothing.
@@ -225,7 +296,6 @@ void bc_result_copy(BcResult *d, BcResult *src) {
 
 #if BC_ENABLED
 		case BC_RESULT_VOID:
-		case BC_RESULT_LAST:
 		{
 #ifndef NDEBUG
 			assert(false);
@@ -235,7 +305,6 @@ void bc_result_copy(BcResult *d, BcResult *src) {
 #endif // BC_ENABLED
 	}
 }
-#endif // DC_ENABLED
 
 void bc_result_free(void *result) {
 
@@ -214,8 +214,9 @@ static BcStatus bc_num_mulArray(const BcNum *restrict a, BcBigDig b,
 	return BC_SIG ? BC_STATUS_SIGNAL : BC_STATUS_SUCCESS;
 }
 
-static BcStatus bc_num_divArray(const BcNum *restrict a, BcBigDig b,
-                                BcNum *restrict c, BcBigDig *rem)
+// a and c may be the same number.
+static BcStatus bc_num_divArray(const BcNum *a, BcBigDig b, BcNum *c,
+                                BcBigDig *rem)
 {
 	size_t i;
 	BcBigDig carry = 0;
@@ -243,15 +244,42 @@ static BcStatus bc_num_divArray(const BcNum *restrict a, BcBigDig b,
 static ssize_t bc_num_compare(const BcDig *restrict a, const BcDig *restrict b,
                               size_t len)
 {
-	size_t i;
-	BcDig c = 0;
-	for (i = len - 1; BC_NO_SIG && i < len && !(c = a[i] - b[i]); --i);
-	return BC_SIG ? BC_NUM_CMP_SIGNAL_VAL : bc_num_neg(i + 1, c < 0);
+	size_t i = len, n;
+	BcDig c;
+
+	// memcmp() only has to say whether a block is equal, which it does much
+	// faster than a limb at a time. The block that differs is then scanned.
+	while (BC_NO_SIG && i) {
+
+		n = BC_MIN(i, BC_NUM_CMP_BLOCK);
+		i -= n;
+
+		if (memcmp(a + i, b + i, BC_NUM_SIZE(n))) {
+			for (i += n - 1; !(c = a[i] - b[i]); --i);
+			return bc_num_neg(i + 1, c < 0);
+		}
+	}
+
+	return BC_SIG ? BC_NUM_CMP_SIGNAL_VAL : 0;
+}
+
+// Returns whether any of the len limbs in n are not zero.
+static bool bc_num_nonzeroDigs(const BcDig *restrict n, size_t len) {
+
+	size_t i, j, end;
+	BcDig any = 0;
+
+	for (i = 0; !any && i < len; i = end) {
+		end = BC_MIN(len, i + BC_NUM_CMP_BLOCK);
+		for (j = i; j < end; ++j) any |= n[j];
+	}
+
+	return any != 0;
 }
 
 ssize_t bc_num_cmp(const BcNum *a, const BcNum *b) {
 
-	size_t i, min, a_int, b_int, diff;
+	size_t min, a_int, b_int, diff;
 	BcDig *max_num, *min_num;
 	bool a_max, neg = false;
 	ssize_t cmp;
@@ -295,11 +323,10 @@ ssize_t bc_num_cmp(const BcNum *a, const BcNum *b) {
 
 	if (cmp) return bc_num_neg((size_t) cmp, !a_max == !neg);
 
-	for (max_num -= diff, i = diff - 1; BC_NO_SIG && i < diff; --i) {
-		if (max_num[i]) return bc_num_neg(1, !a_max == !neg);
-	}
+	if (bc_num_nonzeroDigs(max_num - diff, diff))
+		return bc_num_neg(1, !a_max == !neg);
 
-	return BC_SIG ? BC_NUM_CMP_SIGNAL_VAL : 0;
+	return 0;
 }
 
 void bc_num_truncate(BcNum *restrict n, size_t places) {
@@ -545,6 +572,116 @@ static BcStatus bc_num_shiftRight(BcNum *restrict n, size_t places) {
 	return BC_SIG && !s ? BC_STATUS_SIGNAL : s;
 }
 
+#if BC_ENABLE_EXTRA_MATH
+// This sets c to a times 10^places (or divided by it, if right is true),
+// truncated to scale, in one pass over a. The limbs are written straight into
+// their final places, with the part of the shift that is less than a limb
+// applied as they are copied, instead of copying a, then moving its limbs,
+// and then shifting them.
+static BcStatus bc_num_shiftCopy(const BcNum *restrict a, BcNum *restrict c,
+                                 size_t places, bool right, size_t scale)
+{
+	size_t up, down, limbs, i, n, len, rdx = BC_NUM_RDX(scale);
+	BcBigDig pow, carry = 0;
+	const BcDig *src;
+	BcDig *dst;
+
+	if (BC_NUM_ZERO(a)) {
+		bc_num_setToZero(c, scale);
+		return BC_STATUS_SUCCESS;
+	}
+
+	// Both are in digits. up is how far the limbs of a have to move up, and
+	// down is how far they have to move down. Only the difference matters.
+	up = rdx * BC_BASE_DIGS;
+	down = a->rdx * BC_BASE_DIGS;
+
+	if (right) down += places;
+	else up += places;
+
+	if (BC_ERR((right ? down : up) < places))
+		return bc_vm_err(BC_ERROR_MATH_OVERFLOW);
+
+	if (up >= down) {
+
+		limbs = (up - down) / BC_BASE_DIGS;
+		pow = bc_num_pow10[(up - down) % BC_BASE_DIGS];
+
+		len = a->len + limbs;
+		if (BC_ERR(len < limbs || len >= SIZE_MAX - 1))
+			return bc_vm_err(BC_ERROR_MATH_OVERFLOW);
+		len += 1;
+
+		bc_num_expand(c, len);
+		memset(c->num, 0, BC_NUM_SIZE(limbs));
+	}
+	else {
+
+		limbs = BC_NUM_RDX(down - up);
+		pow = bc_num_pow10[limbs * BC_BASE_DIGS - (down - up)];
+
+		if (limbs > a->len) {
+			bc_num_setToZero(c, scale);
+			return BC_STATUS_SUCCESS;
+		}
+
+		len = a->len - limbs + 1;
+		bc_num_expand(c, len);
+
+		// The carry out of the limb below the lowest one that is kept does
+		// not depend on the limbs below it, because 10^dig divides the base.
+		carry = ((BcBigDig) a->num[limbs - 1]) * pow / BC_BASE_POW;
+	}
+
+	if (up >= down) {
+		src = a->num;
+		dst = c->num + limbs;
+		n = a->len;
+	}
+	else {
+		src = a->num + limbs;
+		dst = c->num;
+		n = a->len - limbs;
+	}
+
+	if (pow == 1) memcpy(dst, src, BC_NUM_SIZE(n));
+	else {
+
+		for (i = 0; BC_NO_SIG && i < n; ++i) {
+			BcBigDig in = ((BcBigDig) src[i]) * pow + carry;
+			dst[i] = (BcDig) (in % BC_BASE_POW);
+			carry = in / BC_BASE_POW;
+		}
+
+		if (BC_SIG) return BC_STATUS_SIGNAL;
+	}
+
+	assert(carry < BC_BASE_POW);
+	c->num[len - 1] = (BcDig) carry;
+	c->len = len;
+
+	if (c->len < rdx) {
+		bc_num_expand(c, rdx);
+		memset(c->num + c->len, 0, BC_NUM_SIZE(rdx - c->len));
+		c->len = rdx;
+	}
+
+	c->rdx = rdx;
+	c->scale = scale;
+	c->neg = a->neg;
+
+	// Clear the digits of the lowest limb that are past the scale.
+	if (rdx && scale % BC_BASE_DIGS) {
+		BcBigDig mod = bc_num_pow10[BC_BASE_DIGS - scale % BC_BASE_DIGS];
+		c->num[0] -= c->num[0] % (BcDig) mod;
+	}
+
+	bc_num_clean(c);
+
+	return BC_STATUS_SUCCESS;
+}
+#endif // BC_ENABLE_EXTRA_MATH
+
 static BcStatus bc_num_inv(BcNum *a, BcNum *b, size_t scale) {
 
 	BcNum one;
@@ -559,16 +696,13 @@ static BcStatus bc_num_inv(BcNum *a, BcNum *b, size_t scale) {
 }
 
 #if BC_ENABLE_EXTRA_MATH
-static BcStatus bc_num_intop(const BcNum *a, const BcNum *b, BcNum *restrict c,
-                             BcBigDig *v)
-{
+static BcStatus bc_num_intop(const BcNum *b, BcBigDig *v) {
 	if (BC_ERR(b->rdx)) return bc_vm_err(BC_ERROR_MATH_NON_INTEGER);
-	bc_num_copy(c, a);
 	return bc_num_bigdig(b, v);
 }
 #endif // BC_ENABLE_EXTRA_MATH
 
-static BcStatus bc_num_as(BcNum *a, BcNum *b, BcNum *restrict c, size_t sub) {
+static BcStatus bc_num_as(BcNum *a, BcNum *b, BcNum *c, size_t sub) {
 
 	BcDig *ptr_c, *ptr_l, *ptr_r;
 	size_t i, min_rdx, max_rdx, diff, a_int, b_int, min_len, max_len, max_int;
@@ -589,6 +723,10 @@ static BcStatus bc_num_as(BcNum *a, BcNum *b, BcNum *restrict c, size_t sub) {
 		return BC_STATUS_SUCCESS;
 	}
 
+	// c is allowed to be the same as a, as long as a->rdx >= b->rdx. Every
+	// digit of a is read before the same digit of c is written in that case.
+	assert(c != b && (c != a || a->rdx >= b->rdx));
+
 	b_neg = (b->neg != sub);
 	do_sub = (a->neg != b_neg);
 
@@ -635,7 +773,7 @@ static BcStatus bc_num_as(BcNum *a, BcNum *b, BcNum *restrict c, size_t sub) {
 	if (diff) {
 
 		if ((a->rdx > b->rdx) != do_rev_sub) {
-			memcpy(ptr_c, ptr_l, BC_NUM_SIZE(diff));
+			if (ptr_c != ptr_l) memcpy(ptr_c, ptr_l, BC_NUM_SIZE(diff));
 			ptr_l += diff;
 			len_l -= diff;
 		}
@@ -701,7 +839,7 @@ static BcStatus bc_num_m_simp(const BcNum *a, const BcNum *b, BcNum *restrict c)
 {
 	size_t i, alen = a->len, blen = b->len, clen;
 	BcDig *ptr_a = a->num, *ptr_b = b->num, *ptr_c;
-	BcBigDig sum = 0, carry = 0;
+	BcBigDig sum, carry = 0;
 
 	assert(sizeof(sum) >= sizeof(BcDig) * 2);
 	assert(!a->rdx && !b->rdx);
@@ -712,35 +850,43 @@ static BcStatus bc_num_m_simp(const BcNum *a, const BcNum *b, BcNum *restrict c)
 	ptr_c = c->num;
 	memset(ptr_c, 0, BC_NUM_SIZE(c->cap));
 
+	// This is Comba's method: each limb of the result is the sum of one
+	// column of partial products. The inner loop only multiplies and adds, and
+	// the carry is split off once per BC_NUM_MUL_TILE products and once at the
+	// end of the column.
 	for (i = 0; BC_NO_SIG && i < clen; ++i) {
 
 		ssize_t sidx = (ssize_t) (i - blen + 1);
 		size_t j = (size_t) BC_MAX(0, sidx), k = BC_MIN(i, blen - 1);
+		size_t n = BC_MIN(alen - j, k + 1);
+
+		sum = carry % BC_BASE_POW;
+		carry /= BC_BASE_POW;
+
+		while (n) {
 
-		for (; BC_NO_SIG && j < alen && k < blen; ++j, --k) {
+			size_t l, tile = BC_MIN(n, BC_NUM_MUL_TILE);
 
-			sum += ((BcBigDig) ptr_a[j]) * ((BcBigDig) ptr_b[k]);
+			for (l = 0; l < tile; ++l)
+				sum += ((BcBigDig) ptr_a[j + l]) * ((BcBigDig) ptr_b[k - l]);
 
-			if (sum >= ((BcBigDig) BC_BASE_POW) * BC_BASE_POW) {
+			j += tile;
+			k -= tile;
+			n -= tile;
+
+			if (n) {
 				carry += sum / BC_BASE_POW;
 				sum %= BC_BASE_POW;
 			}
 		}
 
-		if (sum >= BC_BASE_POW) {
-			carry += sum / BC_BASE_POW;
-			sum %= BC_BASE_POW;
-		}
-
-		ptr_c[i] = (BcDig) sum;
-		assert(ptr_c[i] < BC_BASE_POW);
-		sum = carry;
-		carry = 0;
+		carry += sum / BC_BASE_POW;
+		ptr_c[i] = (BcDig) (sum % BC_BASE_POW);
 	}
 
-	if (sum) {
-		assert(sum < BC_BASE_POW);
-		ptr_c[clen] = (BcDig) sum;
+	if (carry) {
+		assert(carry < BC_BASE_POW);
+		ptr_c[clen] = (BcDig) carry;
 		clen += 1;
 	}
 
@@ -757,11 +903,108 @@ static BcStatus bc_num_shiftAddSub(BcNum *restrict n, const BcNum *restrict a,
 	return op(n->num + shift, a->num, a->len);
 }
 
-static BcStatus bc_num_k(BcNum *a, BcNum *b, BcNum *restrict c) {
+static BcStatus bc_num_mTask(void *data) {
 
 	BcStatus s;
+	BcNumMulTask *t = (BcNumMulTask*) data;
+
+	if (BC_NUM_ZERO(t->a) || BC_NUM_ZERO(t->b)) return BC_STATUS_SUCCESS;
+
+	s = bc_num_m(t->a, t->b, t->c, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+
+	bc_num_clean(t->c);
+
+	return s;
+}
+
+// Multiplies a by a much shorter b. Karatsuba would split both at half of a,
+// which leaves b entirely in the low half and wastes whole sub-products on
+// zeros. Instead, a is cut into pieces as long as b, each piece is multiplied
+// by b as a balanced product, and the results are added in at their offsets.
+// Pieces are done two at a time so that one can go to another thread.
+static BcStatus bc_num_kUnbal(BcNum *a, BcNum *b, BcNum *restrict c) {
+
+	BcStatus s = BC_STATUS_SUCCESS, s2;
+	BcNum pieces[2], prods[2];
+	BcNumMulTask t[2];
+	BcVmTask task;
+	size_t i, j, len, clen = bc_vm_growSize(a->len, b->len);
+
+	assert(BC_NUM_ZERO(c));
+	assert(!a->rdx && !b->rdx);
+	assert(a->len > b->len);
+
+	bc_num_expand(c, bc_vm_growSize(clen, 1));
+	memset(c->num, 0, BC_NUM_SIZE(c->cap));
+	c->len = clen;
+
+	for (j = 0; j < 2; ++j) {
+		bc_num_init(&prods[j], bc_vm_growSize(b->len, b->len));
+		t[j].a = &pieces[j];
+		t[j].b = b;
+		t[j].c = &prods[j];
+	}
+
+	for (i = 0; BC_NO_SIG && i < a->len; i += 2 * b->len) {
+
+		for (j = 0; j < 2; ++j) {
+
+			size_t idx = i + j * b->len;
+
+			// The second piece is empty when a runs out first.
+			if (idx >= a->len) idx = len = 0;
+			else len = BC_MIN(b->len, a->len - idx);
+
+			bc_num_setup(&pieces[j], a->num + idx, len);
+			pieces[j].len = len;
+			bc_num_clean(&pieces[j]);
+
+			bc_num_zero(&prods[j]);
+		}
+
+		if (b->len >= BC_NUM_THREAD_LEN) {
+
+			bc_vm_spawn(&task, bc_num_mTask, &t[1]);
+
+			s = bc_num_mTask(&t[0]);
+
+			s2 = bc_vm_join(&task);
+			if (BC_NO_ERR(!s)) s = s2;
+		}
+		else {
+			s = bc_num_mTask(&t[0]);
+			if (BC_NO_ERR(!s)) s = bc_num_mTask(&t[1]);
+		}
+
+		if (BC_ERR(s)) break;
+
+		for (j = 0; BC_NO_ERR(!s) && j < 2; ++j) {
+			if (BC_NUM_ZERO(&prods[j])) continue;
+			s = bc_num_shiftAddSub(c, &prods[j], i + j * b->len,
+			                       bc_num_addArrays);
+		}
+
+		if (BC_ERR(s)) break;
+	}
+
+	if (BC_NO_ERR(!s) && BC_SIG) s = BC_STATUS_SIGNAL;
+
+	bc_num_clean(c);
+
+	bc_num_free(&prods[1]);
+	bc_num_free(&prods[0]);
+
+	return s;
+}
+
+static BcStatus bc_num_k(BcNum *a, BcNum *b, BcNum *restrict c) {
+
+	BcStatus s, s2;
 	size_t max, max2, total;
 	BcNum l1, h1, l2, h2, m2, m1, z0, z1, z2, temp;
+	BcNumMulTask t0, t1, t2;
+	BcVmTask task0, task2;
 	BcDig *digs, *dig_ptr;
 	BcNumShiftAddOp op;
 	bool aone = BC_NUM_ONE(a);
@@ -778,6 +1021,8 @@ static BcStatus bc_num_k(BcNum *a, BcNum *b, BcNum *restrict c) {
 	}
 	if (a->len < BC_NUM_KARATSUBA_LEN || b->len < BC_NUM_KARATSUBA_LEN)
 		return bc_num_m_simp(a, b, c);
+	if (a->len >= 2 * b->len) return bc_num_kUnbal(a, b, c);
+	if (b->len >= 2 * a->len) return bc_num_kUnbal(b, a, c);
 
 	max = BC_MAX(a->len, b->len);
 	max = BC_MAX(max, BC_NUM_DEF_SIZE);
@@ -816,36 +1061,54 @@ static BcStatus bc_num_k(BcNum *a, BcNum *b, BcNum *restrict c) {
 	s = bc_num_sub(&l2, &h2, &m2, 0);
 	if (BC_ERR(s)) goto err;
 
-	if (BC_NUM_NONZERO(&h1) && BC_NUM_NONZERO(&h2)) {
+	// The three products are independent, so for big enough operands, two
+	// of them are handed off to other threads (if any are available) while
+	// this thread does the third. They are added in afterward, in order.
+	t2.a = &h1;
+	t2.b = &h2;
+	t2.c = &z2;
+	t0.a = &l1;
+	t0.b = &l2;
+	t0.c = &z0;
+	t1.a = &m1;
+	t1.b = &m2;
+	t1.c = &z1;
 
-		s = bc_num_m(&h1, &h2, &z2, 0);
-		if (BC_ERR(s)) goto err;
-		bc_num_clean(&z2);
+	if (max2 >= BC_NUM_THREAD_LEN) {
+
+		bc_vm_spawn(&task2, bc_num_mTask, &t2);
+		bc_vm_spawn(&task0, bc_num_mTask, &t0);
+
+		s = bc_num_mTask(&t1);
+
+		s2 = bc_vm_join(&task2);
+		if (BC_NO_ERR(!s)) s = s2;
+		s2 = bc_vm_join(&task0);
+		if (BC_NO_ERR(!s)) s = s2;
+	}
+	else {
+		s = bc_num_mTask(&t2);
+		if (BC_NO_ERR(!s)) s = bc_num_mTask(&t0);
+		if (BC_NO_ERR(!s)) s = bc_num_mTask(&t1);
+	}
 
+	if (BC_ERR(s)) goto err;
+
+	if (BC_NUM_NONZERO(&z2)) {
 		s = bc_num_shiftAddSub(c, &z2, max2 * 2, bc_num_addArrays);
 		if (BC_ERR(s)) goto err;
 		s = bc_num_shiftAddSub(c, &z2, max2, bc_num_addArrays);
 		if (BC_ERR(s)) goto err;
 	}
 
-	if (BC_NUM_NONZERO(&l1) && BC_NUM_NONZERO(&l2)) {
-
-		s = bc_num_m(&l1, &l2, &z0, 0);
-		if (BC_ERR(s)) goto err;
-		bc_num_clean(&z0);
-
+	if (BC_NUM_NONZERO(&z0)) {
 		s = bc_num_shiftAddSub(c, &z0, max2, bc_num_addArrays);
 		if (BC_ERR(s)) goto err;
 		s = bc_num_shiftAddSub(c, &z0, 0, bc_num_addArrays);
 		if (BC_ERR(s)) goto err;
 	}
 
-	if (BC_NUM_NONZERO(&m1) && BC_NUM_NONZERO(&m2)) {
-
-		s = bc_num_m(&m1, &m2, &z1, 0);
-		if (BC_ERR(s)) goto err;
-		bc_num_clean(&z1);
-
+	if (BC_NUM_NONZERO(&z1)) {
 		op = (m1.neg != m2.neg) ? bc_num_subArrays : bc_num_addArrays;
 		s = bc_num_shiftAddSub(c, &z1, max2, op);
 		if (BC_ERR(s)) goto err;
@@ -938,223 +1201,471 @@ err:
 	return s;
 }
 
-static bool bc_num_nonZeroDig(BcDig *restrict a, size_t len) {
+// This multiplies the len limbs of a by b in place and returns the carry.
+static BcBigDig bc_num_mulDigs(BcDig *restrict a, size_t len, BcBigDig b) {
+
 	size_t i;
-	bool nonzero = false;
-	for (i = len - 1; !nonzero && i < len; --i) nonzero = (a[i] != 0);
-	return nonzero;
+	BcBigDig carry = 0;
+
+	for (i = 0; i < len; ++i) {
+		BcBigDig in = ((BcBigDig) a[i]) * b + carry;
+		a[i] = (BcDig) (in % BC_BASE_POW);
+		carry = in / BC_BASE_POW;
+	}
+
+	return carry;
 }
 
-static ssize_t bc_num_divCmp(const BcDig *a, const BcNum *b, size_t len) {
+// This subtracts q times the len limbs of b from the len + 1 limbs of a and
+// returns true if the result went negative.
+static bool bc_num_mulSubDigs(BcDig *restrict a, const BcDig *restrict b,
+                              size_t len, BcBigDig q)
+{
+	size_t i;
+	BcBigDig carry = 0, borrow = 0, sub;
+
+	for (i = 0; i < len; ++i) {
 
-	ssize_t cmp;
+		BcBigDig prod = ((BcBigDig) b[i]) * q + carry;
 
-	if (b->len > len && a[len]) cmp = bc_num_compare(a, b->num, len + 1);
-	else if (b->len <= len) {
-		if (a[len]) cmp = 1;
-		else cmp = bc_num_compare(a, b->num, len);
+		carry = prod / BC_BASE_POW;
+		sub = prod % BC_BASE_POW + borrow;
+		borrow = ((BcBigDig) a[i] < sub);
+
+		a[i] = (BcDig) ((BcBigDig) a[i] + borrow * BC_BASE_POW - sub);
 	}
-	else cmp = -1;
 
-	return cmp;
+	sub = carry + borrow;
+	borrow = ((BcBigDig) a[len] < sub);
+	a[len] = (BcDig) ((BcBigDig) a[len] + borrow * BC_BASE_POW - sub);
+
+	return borrow != 0;
 }
 
-static BcStatus bc_num_divExtend(BcNum *restrict a, BcNum *restrict b,
-                                 BcBigDig divisor)
-{
-	BcStatus s;
-	size_t pow;
+// The limb that bc_num_d_long() scales its operands by for divisor b.
+static BcBigDig bc_num_divNorm(const BcNum *restrict b) {
+	return BC_BASE_POW / ((BcBigDig) b->num[b->len - 1] + 1);
+}
 
-	pow = BC_BASE_DIGS - bc_num_log10((size_t) divisor);
+static BcBigDig bc_num_remDigs(const BcNum *restrict a, BcBigDig b) {
 
-	s = bc_num_shiftLeft(a, pow);
-	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+	size_t i;
+	BcBigDig rem = 0;
+
+	for (i = a->len - 1; i < a->len; --i)
+		rem = (rem * BC_BASE_POW + (BcBigDig) a->num[i]) % b;
 
-	return bc_num_shiftLeft(b, pow);
+	return rem;
 }
 
+// This is Algorithm D from Knuth's The Art of Computer Programming, Volume 2,
+// section 4.3.1. Both numbers are scaled so that the top limb of b is at least
+// half of BC_BASE_POW. After that, an estimate of each quotient limb from the
+// top two limbs of each is never more than one too big, and that is caught by
+// the multiply and subtract. The remainder is left scaled in a.
 static BcStatus bc_num_d_long(BcNum *restrict a, BcNum *restrict b,
                               BcNum *restrict c, size_t scale)
 {
-	BcStatus s = BC_STATUS_SUCCESS;
-	BcBigDig divisor;
+	BcBigDig v1, v2 = 0, d;
 	size_t len, end, i, rdx;
-	BcNum cpb;
-	bool nonzero = false;
 
 	assert(b->len < a->len);
+	assert(b->num[b->len - 1]);
+
 	len = b->len;
+
+	// The top limb of a must be zero, so that it can take the carry from the
+	// scaling, and so that every window of a starts out less than b.
+	if (a->num[a->len - 1]) {
+		bc_num_expand(a, bc_vm_growSize(a->len, 1));
+		a->num[a->len++] = 0;
+	}
+
 	end = a->len - len;
-	assert(len >= 1);
 
 	bc_num_expand(c, a->len);
-	memset(c->num, 0, c->cap * sizeof(BcDig));
+	memset(c->num, 0, BC_NUM_SIZE(c->cap));
 
 	c->rdx = a->rdx;
 	c->scale = a->scale;
 	c->len = a->len;
 
-	divisor = (BcBigDig) b->num[len - 1];
+	d = bc_num_divNorm(b);
+
+	if (d > 1) {
+		BcBigDig carry = bc_num_mulDigs(b->num, len, d);
+		assert(!carry);
+		carry = bc_num_mulDigs(a->num, a->len, d);
+		assert(!carry);
+		BC_UNUSED(carry);
+	}
+
+	v1 = (BcBigDig) b->num[len - 1];
+	if (len > 1) v2 = (BcBigDig) b->num[len - 2];
+
+	assert(v1 >= BC_BASE_POW / 2);
+
+	assert(c->scale >= scale);
+	rdx = c->rdx - BC_NUM_RDX(scale);
 
-	if (len > 1 && bc_num_nonZeroDig(b->num, len - 1)) {
+	for (i = end - 1; BC_NO_SIG && i < end && i >= rdx; --i) {
 
-		nonzero = (divisor > 1 << ((10 * BC_BASE_DIGS) / 6 + 1));
+		BcDig *n = a->num + i;
+		BcBigDig q, r, u;
 
-		if (!nonzero) {
+		u = ((BcBigDig) n[len]) * BC_BASE_POW + (BcBigDig) n[len - 1];
 
-			s = bc_num_divExtend(a, b, divisor);
-			if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+		assert((BcBigDig) n[len] <= v1);
 
-			len = BC_MAX(a->len, b->len);
-			bc_num_expand(a, len + 1);
+		q = u / v1;
+		r = u % v1;
 
-			if (len + 1 > a->len) a->len = len + 1;
+		if (len > 1) {
 
-			len = b->len;
-			end = a->len - len;
-			divisor = (BcBigDig) b->num[len - 1];
+			BcBigDig u2 = (BcBigDig) n[len - 2];
 
-			nonzero = bc_num_nonZeroDig(b->num, len - 1);
+			while (q >= BC_BASE_POW || q * v2 > r * BC_BASE_POW + u2) {
+				q -= 1;
+				r += v1;
+				if (r >= BC_BASE_POW) break;
+			}
 		}
-	}
 
-	divisor += nonzero;
+		if (q && bc_num_mulSubDigs(n, b->num, len, q)) {
 
-	bc_num_expand(c, a->len);
-	memset(c->num, 0, BC_NUM_SIZE(c->cap));
+			size_t j;
+			bool carry = false;
 
-	assert(c->scale >= scale);
-	rdx = c->rdx - BC_NUM_RDX(scale);
+			q -= 1;
 
-	bc_num_init(&cpb, len + 1);
+			// The carry out of the top limb cancels the borrow, and what is
+			// left is less than b, so the top limb ends up zero.
+			for (j = 0; j < len; ++j)
+				n[j] = bc_num_addDigits(n[j], b->num[j], &carry);
 
-	i = end - 1;
+			n[len] = 0;
+		}
 
-	for (; BC_NO_SIG && i < end && i >= rdx && BC_NUM_NONZERO(a); --i) {
+		assert(q < BC_BASE_POW);
 
-		ssize_t cmp;
-		BcDig *n;
-		BcBigDig q, result;
+		c->num[i] = (BcDig) q;
+	}
 
-		n = a->num + i;
-		assert(n >= a->num);
-		result = q = 0;
+	return BC_SIG ? BC_STATUS_SIGNAL : BC_STATUS_SUCCESS;
+}
 
-		cmp = bc_num_divCmp(n, b, len);
+// Barrett reduction. With k limbs in m and mu = floor(B^(2k) / m), the
+// quotient of a (which must be less than B^(2k)) by m is estimated from the
+// top limbs of a times mu, and the estimate is at most two too small. That
+// turns the division into two multiplications, which Karatsuba makes cheaper
+// than long division once m is long enough.
+static BcStatus bc_num_barrett(const BcNum *restrict a, const BcNum *restrict m,
+                               const BcNum *restrict mu, BcNum *restrict q,
+                               BcNum *restrict r)
+{
+	BcStatus s = BC_STATUS_SUCCESS;
+	BcNum q1, q2, q3, t, cpm, cpmu;
+	size_t i, k = m->len;
+	BcBigDig extra = 0;
 
-#if BC_ENABLE_SIGNALS
-		if (BC_NUM_CMP_SIGNAL(cmp)) goto err;
-#endif // BC_ENABLE_SIGNALS
+	assert(a->len <= 2 * k);
+	assert(!a->neg && !m->neg && !a->rdx && !m->rdx);
 
-		while (cmp >= 0) {
+	bc_num_zero(q);
+	bc_num_copy(r, a);
 
-			BcBigDig n1, dividend;
+	if (a->len < k) return BC_STATUS_SUCCESS;
 
-			n1 = (BcBigDig) n[len];
-			dividend = n1 * BC_BASE_POW + (BcBigDig) n[len - 1];
-			q = (dividend / divisor);
+	bc_num_setup(&q1, a->num + k - 1, a->len - k + 1);
+	q1.len = a->len - k + 1;
+	memcpy(&cpm, m, sizeof(BcNum));
+	memcpy(&cpmu, mu, sizeof(BcNum));
 
-			if (q <= 1) {
-				q = 1;
-				s = bc_num_subArrays(n, b->num, len);
-				if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
-			}
-			else {
+	bc_num_init(&q2, bc_vm_growSize(q1.len, mu->len) + 1);
+	bc_num_init(&t, bc_vm_growSize(a->len, 2));
 
-				assert(q <= BC_BASE_POW);
+	s = bc_num_k(&q1, &cpmu, &q2);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	bc_num_clean(&q2);
 
-				s = bc_num_mulArray(b, (BcBigDig) q, &cpb);
-				if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+	if (q2.len > k + 1) {
 
-				s = bc_num_subArrays(n, cpb.num, cpb.len);
-				if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
-			}
+		bc_num_setup(&q3, q2.num + k + 1, q2.len - k - 1);
+		q3.len = q2.len - k - 1;
 
-			result += q;
-			assert(result <= BC_BASE_POW);
+		s = bc_num_k(&q3, &cpm, &t);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		bc_num_clean(&t);
 
-			if (nonzero) {
-				cmp = bc_num_divCmp(n, b, len);
-#if BC_ENABLE_SIGNALS
-				if (BC_NUM_CMP_SIGNAL(cmp)) goto err;
-#endif // BC_ENABLE_SIGNALS
-			}
-			else cmp = -1;
-		}
+		bc_num_copy(q, &q3);
+	}
+
+	if (BC_NUM_NONZERO(&t)) {
+		s = bc_num_subArrays(r->num, t.num, t.len);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		bc_num_clean(r);
+	}
+
+	while (BC_NO_SIG && bc_num_cmp(r, m) >= 0) {
+		s = bc_num_subArrays(r->num, m->num, m->len);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		bc_num_clean(r);
+		extra += 1;
+	}
+
+	if (BC_SIG) {
+		s = BC_STATUS_SIGNAL;
+		goto err;
+	}
 
-		assert(result < BC_BASE_POW);
+	bc_num_expand(q, bc_vm_growSize(q->len, 1));
 
-		c->num[i] = (BcDig) result;
+	for (i = 0; extra; ++i) {
+		if (i == q->len) q->num[q->len++] = 0;
+		extra += (BcBigDig) q->num[i];
+		q->num[i] = (BcDig) (extra % BC_BASE_POW);
+		extra /= BC_BASE_POW;
 	}
 
 err:
-	if (BC_NO_ERR(!s) && BC_SIG) s = BC_STATUS_SIGNAL;
-	bc_num_free(&cpb);
+	bc_num_free(&t);
+	bc_num_free(&q2);
 	return s;
 }
 
-static BcStatus bc_num_d(BcNum *a, BcNum *b, BcNum *restrict c, size_t scale) {
-
+// Divides the integer a by m with Barrett reduction, k limbs of a at a time,
+// from the top. Each step reduces the remainder so far with the next k limbs
+// of a below it, which is less than m * B^k, and so less than B^(2k). Either
+// q or r may be NULL if that part of the result is not needed.
+static BcStatus bc_num_barrettDiv(const BcNum *restrict a,
+                                  const BcNum *restrict m,
+                                  const BcNum *restrict mu,
+                                  BcNum *restrict q, BcNum *restrict r)
+{
 	BcStatus s = BC_STATUS_SUCCESS;
-	size_t len;
-	BcNum cpa, cpb;
-
-	if (BC_NUM_ZERO(b)) return bc_vm_err(BC_ERROR_MATH_DIVIDE_BY_ZERO);
-	if (BC_NUM_ZERO(a)) {
-		bc_num_setToZero(c, scale);
-		return BC_STATUS_SUCCESS;
-	}
-	if (BC_NUM_ONE(b)) {
-		bc_num_copy(c, a);
-		bc_num_retireMul(c, scale, a->neg, b->neg);
-		return BC_STATUS_SUCCESS;
-	}
-	if (!a->rdx && !b->rdx && b->len == 1 && !scale) {
-		BcBigDig rem;
-		s = bc_num_divArray(a, (BcBigDig) b->num[0], c, &rem);
-		bc_num_retireMul(c, scale, a->neg, b->neg);
-		return s;
-	}
+	BcNum w, wq, wr;
+	size_t i, len, k = m->len;
 
-	len = bc_num_mulReq(a, b, scale);
-	bc_num_init(&cpa, len);
-	bc_num_copy(&cpa, a);
-	bc_num_createCopy(&cpb, b);
+	assert(BC_NUM_NONZERO(a));
 
-	len = b->len;
+	bc_num_init(&w, bc_vm_growSize(2 * k, 1));
+	bc_num_init(&wq, bc_vm_growSize(k, 1));
+	bc_num_init(&wr, bc_vm_growSize(2 * k, 1));
 
-	if (len > cpa.len) {
-		bc_num_expand(&cpa, bc_vm_growSize(len, 2));
-		bc_num_extend(&cpa, (len - cpa.len) * BC_BASE_DIGS);
+	if (q != NULL) {
+		bc_num_expand(q, a->len);
+		memset(q->num, 0, BC_NUM_SIZE(a->len));
+		q->len = a->len;
+		q->rdx = q->scale = 0;
+		q->neg = false;
 	}
 
-	cpa.scale = cpa.rdx * BC_BASE_DIGS;
+	len = a->len % k;
+	if (!len) len = k;
+	i = a->len - len;
 
-	bc_num_extend(&cpa, b->scale);
-	cpa.rdx -= BC_NUM_RDX(b->scale);
-	cpa.scale = cpa.rdx * BC_BASE_DIGS;
+	while (BC_NO_SIG) {
 
-	if (scale > cpa.scale) {
-		bc_num_extend(&cpa, scale);
-		cpa.scale = cpa.rdx * BC_BASE_DIGS;
-	}
+		memcpy(w.num, a->num + i, BC_NUM_SIZE(len));
+		memcpy(w.num + len, wr.num, BC_NUM_SIZE(wr.len));
+		w.len = len + wr.len;
+		bc_num_clean(&w);
 
-	if (cpa.cap == cpa.len) bc_num_expand(&cpa, bc_vm_growSize(cpa.len, 1));
+		s = bc_num_barrett(&w, m, mu, &wq, &wr);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 
-	// We want an extra zero in front to make things simpler.
-	cpa.num[cpa.len++] = 0;
+		if (q != NULL) {
+			assert(wq.len <= len);
+			memcpy(q->num + i, wq.num, BC_NUM_SIZE(wq.len));
+		}
 
-	if (cpa.rdx == cpa.len) cpa.len = bc_num_nonzeroLen(&cpa);
-	if (cpb.rdx == cpb.len) cpb.len = bc_num_nonzeroLen(&cpb);
-	cpb.scale = cpb.rdx = 0;
+		if (!i) break;
 
-	s = bc_num_d_long(&cpa, &cpb, c, scale);
+		i -= k;
+		len = k;
+	}
 
-	if (BC_NO_ERR(!s)) {
+	if (BC_SIG) {
+		s = BC_STATUS_SIGNAL;
+		goto err;
+	}
+
+	if (q != NULL) bc_num_clean(q);
+	if (r != NULL) bc_num_copy(r, &wr);
+
+err:
+	bc_num_free(&wr);
+	bc_num_free(&wq);
+	bc_num_free(&w);
+	return s;
+}
+
+// Looks up the Barrett reciprocal of m, a divisor of at least
+// BC_NUM_BARRETT_LEN limbs, in the cache in the vm. Only divisors that come
+// back are worth a reciprocal, so the first time m is seen, it is only
+// remembered, and mu is set to NULL. Entries are matched by their limbs, so a
+// variable that was changed can never hit a stale entry. Only the main thread
+// uses the cache; divisions in other threads always get NULL.
+static BcStatus bc_num_recip(const BcNum *restrict m, BcNum **mu) {
+
+	BcStatus s = BC_STATUS_SUCCESS;
+	BcNumRecip *e = NULL;
+	size_t i;
+
+	assert(m->len >= BC_NUM_BARRETT_LEN && !m->rdx);
+
+	*mu = NULL;
+
+	if (!BC_VM_MAIN_THREAD) return s;
+
+	for (i = 0; i < BC_NUM_RECIP_CACHE; ++i) {
+		e = vm->recips + i;
+		if (e->m.len == m->len &&
+		    !memcmp(e->m.num, m->num, BC_NUM_SIZE(m->len)))
+		{
+			break;
+		}
+	}
+
+	if (i == BC_NUM_RECIP_CACHE) {
+		e = vm->recips + vm->recip_idx;
+		vm->recip_idx = (vm->recip_idx + 1) % BC_NUM_RECIP_CACHE;
+		bc_num_copy(&e->m, m);
+		e->m.neg = false;
+		bc_num_zero(&e->mu);
+		return s;
+	}
+
+	if (BC_NUM_ZERO(&e->mu)) {
+
+		BcNum pow, cpm;
+		size_t len = bc_vm_growSize(2 * m->len, 1);
+
+		bc_num_init(&pow, len);
+		memset(pow.num, 0, BC_NUM_SIZE(len));
+		pow.num[len - 1] = 1;
+		pow.len = len;
+
+		bc_num_createCopy(&cpm, m);
+
+		s = bc_num_d_long(&pow, &cpm, &e->mu, 0);
+
+		bc_num_free(&cpm);
+		bc_num_free(&pow);
+
+		bc_num_clean(&e->mu);
+
+		if (BC_ERR(s)) {
+			bc_num_zero(&e->mu);
+			return s;
+		}
+	}
+
+	*mu = &e->mu;
+
+	return s;
+}
+
+static BcStatus bc_num_d(BcNum *a, BcNum *b, BcNum *restrict c, size_t scale) {
+
+	BcStatus s = BC_STATUS_SUCCESS;
+	size_t len;
+	BcNum cpa, cpb, *mu = NULL;
+
+	if (BC_NUM_ZERO(b)) return bc_vm_err(BC_ERROR_MATH_DIVIDE_BY_ZERO);
+	if (BC_NUM_ZERO(a)) {
+		bc_num_setToZero(c, scale);
+		return BC_STATUS_SUCCESS;
+	}
+	if (BC_NUM_ONE(b)) {
+		bc_num_copy(c, a);
+		bc_num_retireMul(c, scale, a->neg, b->neg);
+		return BC_STATUS_SUCCESS;
+	}
+	if (!b->rdx && b->len == 1) {
+
+		BcBigDig rem;
+		size_t zeros = 0;
+
+		// A divisor that fits in one limb just needs one pass over the
+		// dividend, which is first given enough zero limbs below the point
+		// for the requested scale.
+		if (scale > a->scale) zeros = BC_NUM_RDX(scale) - a->rdx;
+
+		bc_num_expand(c, bc_vm_growSize(a->len, zeros));
+		memset(c->num, 0, BC_NUM_SIZE(zeros));
+		memcpy(c->num + zeros, a->num, BC_NUM_SIZE(a->len));
+
+		c->len = a->len + zeros;
+		c->rdx = a->rdx + zeros;
+		c->scale = c->rdx * BC_BASE_DIGS;
+		c->neg = false;
+
+		s = bc_num_divArray(c, (BcBigDig) b->num[0], c, &rem);
+		if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+
+		bc_num_retireMul(c, scale, a->neg, b->neg);
+
+		return s;
+	}
+
+	len = bc_num_mulReq(a, b, scale);
+	bc_num_init(&cpa, len);
+	bc_num_copy(&cpa, a);
+	bc_num_createCopy(&cpb, b);
+
+	len = b->len;
+
+	if (len > cpa.len) {
+		bc_num_expand(&cpa, bc_vm_growSize(len, 2));
+		bc_num_extend(&cpa, (len - cpa.len) * BC_BASE_DIGS);
+	}
+
+	cpa.scale = cpa.rdx * BC_BASE_DIGS;
+
+	bc_num_extend(&cpa, b->scale);
+	cpa.rdx -= BC_NUM_RDX(b->scale);
+	cpa.scale = cpa.rdx * BC_BASE_DIGS;
+
+	if (scale > cpa.scale) {
+		bc_num_extend(&cpa, scale);
+		cpa.scale = cpa.rdx * BC_BASE_DIGS;
+	}
+
+	if (cpa.cap == cpa.len) bc_num_expand(&cpa, bc_vm_growSize(cpa.len, 1));
+
+	// We want an extra zero in front to make things simpler.
+	cpa.num[cpa.len++] = 0;
+
+	if (cpa.rdx == cpa.len) cpa.len = bc_num_nonzeroLen(&cpa);
+	if (cpb.rdx == cpb.len) cpb.len = bc_num_nonzeroLen(&cpb);
+	cpb.scale = cpb.rdx = 0;
+
+	cpa.neg = cpb.neg = false;
+
+	if (cpb.len >= BC_NUM_BARRETT_LEN) {
+		s = bc_num_recip(&cpb, &mu);
+		if (BC_ERR(s)) goto err;
+	}
+
+	if (mu != NULL) {
+
+		s = bc_num_barrettDiv(&cpa, &cpb, mu, c, NULL);
+
+		if (BC_NO_ERR(!s)) {
+			c->rdx = cpa.rdx;
+			c->scale = cpa.scale;
+			bc_num_clean(c);
+		}
+	}
+	else s = bc_num_d_long(&cpa, &cpb, c, scale);
+
+	if (BC_NO_ERR(!s)) {
 		if (BC_SIG) s = BC_STATUS_SIGNAL;
 		else bc_num_retireMul(c, scale, a->neg, b->neg);
 	}
 
+err:
 	bc_num_free(&cpb);
 	bc_num_free(&cpa);
 
@@ -1198,6 +1709,81 @@ err:
 	return s;
 }
 
+// This runs long division on copies of the magnitudes of a and b and keeps
+// what is left of the dividend. That is the remainder, still scaled by the
+// normalization limb, which is then divided back out.
+static BcStatus bc_num_remLong(const BcNum *restrict a, const BcNum *restrict b,
+                               BcNum *restrict c)
+{
+	BcStatus s;
+	BcNum cpa, cpb, q;
+	BcBigDig d, rem;
+
+	bc_num_init(&cpa, bc_vm_growSize(a->len, 1));
+	bc_num_copy(&cpa, a);
+	cpa.num[cpa.len++] = 0;
+
+	bc_num_createCopy(&cpb, b);
+	bc_num_init(&q, cpa.len);
+
+	s = bc_num_d_long(&cpa, &cpb, &q, 0);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+	cpa.len = b->len;
+	bc_num_clean(&cpa);
+
+	d = bc_num_divNorm(b);
+
+	if (d > 1 && BC_NUM_NONZERO(&cpa)) {
+		s = bc_num_divArray(&cpa, d, &cpa, &rem);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		assert(!rem);
+	}
+
+	bc_num_copy(c, &cpa);
+
+err:
+	bc_num_free(&q);
+	bc_num_free(&cpb);
+	bc_num_free(&cpa);
+	return s;
+}
+
+// The remainder of two integers at scale 0, which never needs the quotient.
+// Moduli that are used over and over, as in modular arithmetic, get a cached
+// Barrett reciprocal from bc_num_recip().
+static BcStatus bc_num_remInt(BcNum *a, BcNum *b, BcNum *restrict c) {
+
+	BcStatus s = BC_STATUS_SUCCESS;
+	BcNum cpa, cpb, *mu = NULL;
+
+	assert(!a->rdx && !b->rdx);
+	assert(BC_NUM_NONZERO(a) && BC_NUM_NONZERO(b));
+
+	memcpy(&cpa, a, sizeof(BcNum));
+	memcpy(&cpb, b, sizeof(BcNum));
+	cpa.neg = cpb.neg = false;
+
+	if (b->len == 1) {
+		bc_num_bigdig2num(c, bc_num_remDigs(a, (BcBigDig) b->num[0]));
+	}
+	else if (a->len < b->len) bc_num_copy(c, &cpa);
+	else {
+
+		if (b->len >= BC_NUM_BARRETT_LEN) {
+			s = bc_num_recip(&cpb, &mu);
+			if (BC_ERR(s)) return s;
+		}
+
+		if (mu != NULL) s = bc_num_barrettDiv(&cpa, &cpb, mu, NULL, c);
+		else s = bc_num_remLong(&cpa, &cpb, c);
+	}
+
+	if (BC_NO_ERR(!s) && BC_NUM_NONZERO(c)) c->neg = a->neg;
+
+	return s;
+}
+
 static BcStatus bc_num_rem(BcNum *a, BcNum *b, BcNum *restrict c, size_t scale)
 {
 	BcStatus s;
@@ -1207,6 +1793,14 @@ static BcStatus bc_num_rem(BcNum *a, BcNum *b, BcNum *restrict c, size_t scale)
 	ts = bc_vm_growSize(scale, b->scale);
 	ts = BC_MAX(ts, a->scale);
 
+	if (!ts && BC_NUM_NONZERO(b)) {
+		if (BC_NUM_ZERO(a)) {
+			bc_num_setToZero(c, 0);
+			return BC_STATUS_SUCCESS;
+		}
+		return bc_num_remInt(a, b, c);
+	}
+
 	bc_num_init(&c1, bc_num_mulReq(a, b, ts));
 	s = bc_num_r(a, b, &c1, c, scale, ts);
 	bc_num_free(&c1);
@@ -1214,6 +1808,103 @@ static BcStatus bc_num_rem(BcNum *a, BcNum *b, BcNum *restrict c, size_t scale)
 	return s;
 }
 
+// Returns how many zeros follow the one if n is an integer power of 10 other
+// than 1, or 0 otherwise.
+static size_t bc_num_pow10Zeros(const BcNum *restrict n) {
+
+	size_t i, top;
+
+	if (n->rdx || n->scale || BC_NUM_ZERO(n)) return 0;
+
+	for (top = n->len - 1, i = 0; i < top; ++i) {
+		if (n->num[i]) return 0;
+	}
+
+	for (i = 0; i < BC_BASE_DIGS; ++i) {
+		if ((BcBigDig) n->num[top] == bc_num_pow10[i])
+			return top * BC_BASE_DIGS + i;
+	}
+
+	return 0;
+}
+
+static void bc_num_swap(BcNum *restrict a, BcNum *restrict b) {
+	BcNum temp = *a;
+	*a = *b;
+	*b = temp;
+}
+
+// Raises an integer that is either a power of 10 or fits in one limb to a
+// positive integer power. Powers of 10 are built directly. Other bases are
+// multiplied in one limb at a time, as many factors at once as fit in a limb,
+// until the result is about as long as Karatsuba needs. After that, it goes
+// through the rest of the exponent from the top, squaring and multiplying by
+// the base, which is still one limb.
+static BcStatus bc_num_intPow(const BcNum *restrict a, BcBigDig pow,
+                              BcNum *restrict c)
+{
+	BcStatus s = BC_STATUS_SUCCESS;
+	BcNum temp;
+	BcBigDig base, mult, e, bits;
+	size_t i, shift, len, zeros = bc_num_pow10Zeros(a);
+	bool neg = a->neg && (pow & 1);
+
+	if (zeros) {
+
+		zeros = bc_vm_arraySize((size_t) pow, zeros);
+		len = zeros / BC_BASE_DIGS + 1;
+
+		bc_num_expand(c, len);
+		memset(c->num, 0, BC_NUM_SIZE(len - 1));
+		c->num[len - 1] = (BcDig) bc_num_pow10[zeros % BC_BASE_DIGS];
+		c->len = len;
+		c->rdx = c->scale = 0;
+		c->neg = neg;
+
+		return BC_STATUS_SUCCESS;
+	}
+
+	assert(a->len == 1 && !a->rdx && a->num[0] > 1);
+
+	base = (BcBigDig) a->num[0];
+
+	// A limb has at least 3 bits for every decimal digit.
+	for (bits = 0, e = base; e; e >>= 1) bits += 1;
+	for (shift = 0; (pow >> shift) * bits >
+	     BC_NUM_KARATSUBA_LEN * BC_BASE_DIGS * 3; ++shift);
+
+	bc_num_init(&temp, BC_NUM_DEF_SIZE);
+	bc_num_one(c);
+
+	for (e = pow >> shift; BC_NO_SIG && e; ) {
+
+		for (mult = 1; e && mult * base <= BC_BASE_POW; --e) mult *= base;
+
+		s = bc_num_mulArray(c, mult, &temp);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		bc_num_swap(c, &temp);
+	}
+
+	for (i = shift; BC_NO_SIG && i--;) {
+
+		s = bc_num_mul(c, c, c, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+		if ((pow >> i) & 1) {
+			s = bc_num_mulArray(c, base, &temp);
+			if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+			bc_num_swap(c, &temp);
+		}
+	}
+
+	if (BC_NO_SIG) c->neg = neg;
+	else s = BC_STATUS_SIGNAL;
+
+err:
+	bc_num_free(&temp);
+	return s;
+}
+
 static BcStatus bc_num_p(BcNum *a, BcNum *b, BcNum *restrict c, size_t scale) {
 
 	BcStatus s = BC_STATUS_SUCCESS;
@@ -1252,27 +1943,35 @@ static BcStatus bc_num_p(BcNum *a, BcNum *b, BcNum *restrict c, size_t scale) {
 		scale = BC_MIN(scalepow, max);
 	}
 
-	for (powrdx = a->scale; BC_NO_SIG && !(pow & 1); pow >>= 1) {
-		powrdx <<= 1;
-		s = bc_num_mul(&copy, &copy, &copy, powrdx);
+	if (!a->scale && ((a->len == 1 && a->num[0] > 1) || bc_num_pow10Zeros(a)))
+	{
+		s = bc_num_intPow(a, pow, c);
 		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 	}
+	else {
 
-	if (BC_SIG) goto sig_err;
+		for (powrdx = a->scale; BC_NO_SIG && !(pow & 1); pow >>= 1) {
+			powrdx <<= 1;
+			s = bc_num_mul(&copy, &copy, &copy, powrdx);
+			if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		}
 
-	bc_num_copy(c, &copy);
-	resrdx = powrdx;
+		if (BC_SIG) goto sig_err;
 
-	while (BC_NO_SIG && (pow >>= 1)) {
+		bc_num_copy(c, &copy);
+		resrdx = powrdx;
 
-		powrdx <<= 1;
-		s = bc_num_mul(&copy, &copy, &copy, powrdx);
-		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+		while (BC_NO_SIG && (pow >>= 1)) {
 
-		if (pow & 1) {
-			resrdx += powrdx;
-			s = bc_num_mul(c, &copy, c, resrdx);
+			powrdx <<= 1;
+			s = bc_num_mul(&copy, &copy, &copy, powrdx);
 			if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+
+			if (pow & 1) {
+				resrdx += powrdx;
+				s = bc_num_mul(c, &copy, c, resrdx);
+				if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
+			}
 		}
 	}
 
@@ -1304,13 +2003,10 @@ static BcStatus bc_num_place(BcNum *a, BcNum *b, BcNum *restrict c,
 
 	BC_UNUSED(scale);
 
-	s = bc_num_intop(a, b, c, &val);
+	s = bc_num_intop(b, &val);
 	if (BC_ERR(s)) return s;
 
-	if (val < c->scale) bc_num_truncate(c, c->scale - val);
-	else if (val > c->scale) bc_num_extend(c, val - c->scale);
-
-	return s;
+	return bc_num_shiftCopy(a, c, 0, false, (size_t) val);
 }
 
 static BcStatus bc_num_left(BcNum *a, BcNum *b, BcNum *restrict c, size_t scale)
@@ -1320,10 +2016,12 @@ static BcStatus bc_num_left(BcNum *a, BcNum *b, BcNum *restrict c, size_t scale)
 
 	BC_UNUSED(scale);
 
-	s = bc_num_intop(a, b, c, &val);
+	s = bc_num_intop(b, &val);
 	if (BC_ERR(s)) return s;
 
-	return bc_num_shiftLeft(c, (size_t) val);
+	scale = a->scale > val ? a->scale - (size_t) val : 0;
+
+	return bc_num_shiftCopy(a, c, (size_t) val, false, scale);
 }
 
 static BcStatus bc_num_right(BcNum *a, BcNum *b, BcNum *restrict c,
@@ -1334,12 +2032,17 @@ static BcStatus bc_num_right(BcNum *a, BcNum *b, BcNum *restrict c,
 
 	BC_UNUSED(scale);
 
-	s = bc_num_intop(a, b, c, &val);
+	s = bc_num_intop(b, &val);
 	if (BC_ERR(s)) return s;
 
-	if (BC_NUM_ZERO(c)) return s;
+	if (BC_NUM_ZERO(a)) {
+		bc_num_setToZero(c, a->scale);
+		return s;
+	}
+
+	scale = bc_vm_growSize(a->scale, (size_t) val);
 
-	return bc_num_shiftRight(c, (size_t) val);
+	return bc_num_shiftCopy(a, c, (size_t) val, true, scale);
 }
 #endif // BC_ENABLE_EXTRA_MATH
 
@@ -1483,6 +2186,164 @@ static void bc_num_parseDecimal(BcNum *restrict n, const char *restrict val) {
 	}
 }
 
+// This pushes base^len onto pows, then squares it until there are k of them
+// or, if n is not NULL, until the last one is greater than n.
+static BcStatus bc_num_convPows(BcVec *restrict pows, BcBigDig base,
+                                size_t len, size_t k, const BcNum *n)
+{
+	BcStatus s;
+	BcNum b, exp, next, *last;
+	ssize_t cmp;
+
+	bc_num_createFromBigdig(&b, base);
+	bc_num_createFromBigdig(&exp, (BcBigDig) len);
+	bc_num_init(&next, BC_NUM_DEF_SIZE);
+
+	s = bc_num_pow(&b, &exp, &next, 0);
+
+	bc_num_free(&exp);
+	bc_num_free(&b);
+
+	if (BC_ERR(s)) {
+		bc_num_free(&next);
+		return s;
+	}
+
+	bc_vec_push(pows, &next);
+
+	while (n != NULL || pows->len < k) {
+
+		last = bc_vec_top(pows);
+
+		if (n != NULL) {
+			cmp = bc_num_cmp(n, last);
+			if (BC_NUM_CMP_SIGNAL(cmp)) return BC_STATUS_SIGNAL;
+			if (cmp < 0) break;
+		}
+
+		bc_num_init(&next, bc_vm_growSize(last->len, last->len));
+
+		s = bc_num_mul(last, last, &next, 0);
+		if (BC_ERR(s)) {
+			bc_num_free(&next);
+			return s;
+		}
+
+		bc_vec_push(pows, &next);
+	}
+
+	return BC_STATUS_SUCCESS;
+}
+
+static BcStatus bc_num_parseInt(BcNum *restrict n, const char *restrict val,
+                                size_t len, BcBigDig base)
+{
+	BcStatus s = BC_STATUS_SUCCESS;
+	BcNum temp, mult;
+	size_t i;
+
+	bc_num_init(&temp, BC_NUM_BIGDIG_LOG10);
+	bc_num_init(&mult, BC_NUM_BIGDIG_LOG10);
+
+	for (i = 0; i < len; ++i) {
+
+		BcBigDig v = bc_num_parseChar(val[i], base);
+
+		s = bc_num_mulArray(n, base, &mult);
+		if (BC_ERROR_SIGNAL_ONLY(s)) break;
+		bc_num_bigdig2num(&temp, v);
+		s = bc_num_add(&mult, &temp, n, 0);
+		if (BC_ERROR_SIGNAL_ONLY(s)) break;
+	}
+
+	bc_num_free(&mult);
+	bc_num_free(&temp);
+
+	return s;
+}
+
+// This parses the low half of the characters and the high half on their own,
+// and then combines them as hi * base^len + lo. Both halves can be parsed at
+// the same time, so the high one goes to another thread, if there is one.
+static BcStatus bc_num_parseSplit(void *data) {
+
+	BcStatus s, s2;
+	BcNumParseTask *t = (BcNumParseTask*) data, hi, lo;
+	BcVmTask task;
+	BcNum *pow;
+	size_t half;
+
+	if (BC_SIG) return BC_STATUS_SIGNAL;
+	if (!t->k) return bc_num_parseInt(&t->n, t->val, t->len, t->base);
+
+	half = (BC_NUM_CONV_LEN * BC_BASE_DIGS) << (t->k - 1);
+
+	if (t->len <= half) {
+		t->k -= 1;
+		return bc_num_parseSplit(t);
+	}
+
+	memcpy(&hi, t, sizeof(BcNumParseTask));
+	memcpy(&lo, t, sizeof(BcNumParseTask));
+
+	hi.k = lo.k = t->k - 1;
+	pow = t->pows + hi.k;
+	hi.len = t->len - half;
+	lo.val = t->val + hi.len;
+	lo.len = half;
+
+	bc_num_init(&hi.n, BC_NUM_DEF_SIZE);
+	bc_num_init(&lo.n, BC_NUM_DEF_SIZE);
+
+	bc_vm_spawn(&task, bc_num_parseSplit, &hi);
+	s = bc_num_parseSplit(&lo);
+	s2 = bc_vm_join(&task);
+
+	if (BC_NO_ERR(!s)) s = s2;
+	if (BC_NO_ERR(!s)) s = bc_num_fma(&hi.n, pow, &lo.n, &t->n, 0);
+
+	bc_num_free(&lo.n);
+	bc_num_free(&hi.n);
+
+	return s;
+}
+
+static BcStatus bc_num_parseConv(BcNum *restrict n, const char *restrict val,
+                                 size_t len, BcBigDig base)
+{
+	BcStatus s;
+	BcVec pows;
+	BcNumParseTask t;
+	size_t k, chars = BC_NUM_CONV_LEN * BC_BASE_DIGS;
+
+	// Even without threads, this is faster than going character by character
+	// because the multiplications to combine halves can use Karatsuba.
+	if (len < 2 * chars) return bc_num_parseInt(n, val, len, base);
+
+	for (k = 1; (chars << k) < len; ++k);
+
+	bc_vec_init(&pows, sizeof(BcNum), bc_num_free);
+
+	s = bc_num_convPows(&pows, base, chars, k, NULL);
+	if (BC_ERR(s)) goto err;
+
+	t.pows = (BcNum*) pows.v;
+	t.k = k;
+	t.val = val;
+	t.len = len;
+	t.base = base;
+	bc_num_init(&t.n, BC_NUM_DEF_SIZE);
+
+	s = bc_num_parseSplit(&t);
+	if (BC_NO_ERR(!s)) bc_num_copy(n, &t.n);
+
+	bc_num_free(&t.n);
+
+err:
+	bc_vec_free(&pows);
+	return s;
+}
+
 static BcStatus bc_num_parseBase(BcNum *restrict n, const char *restrict val,
                                  BcBigDig base)
 {
@@ -1499,18 +2360,12 @@ static BcStatus bc_num_parseBase(BcNum *restrict n, const char *restrict val,
 	bc_num_init(&temp, BC_NUM_BIGDIG_LOG10);
 	bc_num_init(&mult1, BC_NUM_BIGDIG_LOG10);
 
-	for (i = 0; i < len && (c = val[i]) && c != '.'; ++i) {
+	for (i = 0; i < len && (c = val[i]) != '.'; ++i);
 
-		v = bc_num_parseChar(c, base);
+	s = bc_num_parseConv(n, val, i, base);
+	if (BC_ERROR_SIGNAL_ONLY(s)) goto int_err;
 
-		s = bc_num_mulArray(n, base, &mult1);
-		if (BC_ERROR_SIGNAL_ONLY(s)) goto int_err;
-		bc_num_bigdig2num(&temp, v);
-		s = bc_num_add(&mult1, &temp, n, 0);
-		if (BC_ERROR_SIGNAL_ONLY(s)) goto int_err;
-	}
-
-	if (i == len && !(c = val[i])) goto int_err;
+	if (i == len) goto int_err;
 
 	assert(c == '.');
 	bc_num_init(&mult2, BC_NUM_BIGDIG_LOG10);
@@ -1659,7 +2514,7 @@ static BcStatus bc_num_printExponent(const BcNum *restrict n, bool eng) {
 	size_t places, mod;
 	BcDig digs[BC_NUM_BIGDIG_LOG10];
 
-	bc_num_createCopy(&temp, n);
+	bc_num_init(&temp, bc_vm_growSize(n->len, 1));
 
 	if (neg) {
 
@@ -1676,14 +2531,18 @@ static BcStatus bc_num_printExponent(const BcNum *restrict n, bool eng) {
 		mod = places % 3;
 
 		if (eng && mod != 0) places += 3 - mod;
-		s = bc_num_shiftLeft(&temp, places);
+
+		mod = n->scale > places ? n->scale - places : 0;
+		s = bc_num_shiftCopy(n, &temp, places, false, mod);
 		if (BC_ERROR_SIGNAL_ONLY(s)) goto exit;
 	}
 	else {
 		places = bc_num_intDigits(n) - 1;
 		mod = places % 3;
 		if (eng && mod != 0) places -= 3 - (3 - mod);
-		s = bc_num_shiftRight(&temp, places);
+
+		mod = bc_vm_growSize(n->scale, places);
+		s = bc_num_shiftCopy(n, &temp, places, true, mod);
 		if (BC_ERROR_SIGNAL_ONLY(s)) goto exit;
 	}
 
@@ -1755,27 +2614,129 @@ static BcStatus bc_num_printPrepare(BcNum *restrict n, BcBigDig rem,
 	for (i = 0; BC_NO_SIG && BC_NO_ERR(!s) && i < n->len; ++i)
 		s = bc_num_printFixup(n, rem, pow, i);
 
-	if (BC_ERR(s)) return s;
+	if (BC_ERR(s)) return s;
+
+	for (i = 0; BC_NO_SIG && i < n->len; ++i) {
+
+		assert(pow == ((BcBigDig) ((BcDig) pow)));
+
+		if (n->num[i] >= (BcDig) pow) {
+
+			if (i + 1 == n->len) {
+				n->len = bc_vm_growSize(n->len, 1);
+				bc_num_expand(n, n->len);
+				n->num[i + 1] = 0;
+			}
+
+			assert(pow < BC_BASE_POW);
+			n->num[i + 1] += n->num[i] / ((BcDig) pow);
+			n->num[i] %= (BcDig) pow;
+		}
+	}
+
+	return BC_NO_ERR(!s) && BC_SIG ? BC_STATUS_SIGNAL : BC_STATUS_SUCCESS;
+}
+
+// This converts n into digits of base pow, stored in digs. It divides n by a
+// power of pow, and converts the quotient and remainder on their own, the
+// quotient in another thread, if there is one.
+static BcStatus bc_num_printSplit(void *data) {
+
+	BcStatus s, s2;
+	BcNumPrintTask *t = (BcNumPrintTask*) data, hi, lo;
+	BcVmTask task;
+	size_t half;
+
+	if (BC_SIG) return BC_STATUS_SIGNAL;
+
+	if (!t->k) {
+
+		s = bc_num_printPrepare(&t->n, t->rem, t->pow);
+		if (BC_ERR(s)) return s;
+
+		assert(t->n.len <= BC_NUM_CONV_LEN);
+
+		memcpy(t->digs, t->n.num, BC_NUM_SIZE(t->n.len));
+		memset(t->digs + t->n.len, 0, BC_NUM_SIZE(BC_NUM_CONV_LEN - t->n.len));
+
+		return s;
+	}
+
+	half = BC_NUM_CONV_LEN << (t->k - 1);
+
+	memcpy(&hi, t, sizeof(BcNumPrintTask));
+	memcpy(&lo, t, sizeof(BcNumPrintTask));
+
+	hi.k = lo.k = t->k - 1;
+	hi.digs = t->digs + half;
+
+	bc_num_init(&hi.n, BC_NUM_DEF_SIZE);
+	bc_num_init(&lo.n, BC_NUM_DEF_SIZE);
+
+	s = bc_num_divmod(&t->n, t->pows + hi.k, &hi.n, &lo.n, 0);
+
+	if (BC_NO_ERR(!s)) {
+
+		bc_vm_spawn(&task, bc_num_printSplit, &hi);
+		s = bc_num_printSplit(&lo);
+		s2 = bc_vm_join(&task);
+
+		if (BC_NO_ERR(!s)) s = s2;
+	}
+
+	bc_num_free(&lo.n);
+	bc_num_free(&hi.n);
+
+	return s;
+}
+
+static BcStatus bc_num_printConv(BcNum *restrict n, BcBigDig rem,
+                                 BcBigDig pow)
+{
+	BcStatus s;
+	BcVec pows;
+	BcNumPrintTask t;
+	BcNum out;
+	size_t k;
+
+	// Splitting costs divisions, so it is only worth it to use threads.
+	if (!BC_VM_THREADED || n->len < 2 * BC_NUM_CONV_LEN)
+		return bc_num_printPrepare(n, rem, pow);
+
+	bc_vec_init(&pows, sizeof(BcNum), bc_num_free);
+
+	s = bc_num_convPows(&pows, pow, BC_NUM_CONV_LEN, 0, n);
+	if (BC_ERR(s)) goto err;
+
+	k = pows.len - 1;
 
-	for (i = 0; BC_NO_SIG && i < n->len; ++i) {
+	bc_num_init(&out, BC_NUM_CONV_LEN << k);
 
-		assert(pow == ((BcBigDig) ((BcDig) pow)));
+	t.pows = (BcNum*) pows.v;
+	t.k = k;
+	t.digs = out.num;
+	t.rem = rem;
+	t.pow = pow;
+	memcpy(&t.n, n, sizeof(BcNum));
 
-		if (n->num[i] >= (BcDig) pow) {
+	s = bc_num_printSplit(&t);
 
-			if (i + 1 == n->len) {
-				n->len = bc_vm_growSize(n->len, 1);
-				bc_num_expand(n, n->len);
-				n->num[i + 1] = 0;
-			}
+	memcpy(n, &t.n, sizeof(BcNum));
 
-			assert(pow < BC_BASE_POW);
-			n->num[i + 1] += n->num[i] / ((BcDig) pow);
-			n->num[i] %= (BcDig) pow;
-		}
+	if (BC_ERR(s)) {
+		bc_num_free(&out);
+		goto err;
 	}
 
-	return BC_NO_ERR(!s) && BC_SIG ? BC_STATUS_SIGNAL : BC_STATUS_SUCCESS;
+	out.len = BC_NUM_CONV_LEN << k;
+	bc_num_clean(&out);
+
+	bc_num_free(n);
+	memcpy(n, &out, sizeof(BcNum));
+
+err:
+	bc_vec_free(&pows);
+	return s;
 }
 
 static BcStatus bc_num_printNum(BcNum *restrict n, BcBigDig base,
@@ -1855,7 +2816,7 @@ static BcStatus bc_num_printNum(BcNum *restrict n, BcBigDig base,
 	exp = vm->last_exp;
 
 	if (vm->last_rem != 0) {
-		s = bc_num_printPrepare(&intp, vm->last_rem, vm->last_pow);
+		s = bc_num_printConv(&intp, vm->last_rem, vm->last_pow);
 		if (BC_ERROR_SIGNAL_ONLY(s)) goto err;
 	}
 
@@ -1985,14 +2946,30 @@ void bc_num_setup(BcNum *restrict n, BcDig *restrict num, size_t cap) {
 }
 
 void bc_num_init(BcNum *restrict n, size_t req) {
+
 	assert(n != NULL);
+
+	if (req <= BC_NUM_DEF_SIZE && BC_VM_MAIN_THREAD && vm->pool_len) {
+		bc_num_setup(n, vm->pool[--vm->pool_len], BC_NUM_DEF_SIZE);
+		return;
+	}
+
 	req = req >= BC_NUM_DEF_SIZE ? req : BC_NUM_DEF_SIZE;
 	bc_num_setup(n, bc_vm_malloc(BC_NUM_SIZE(req)), req);
 }
 
 void bc_num_free(void *num) {
-	assert(num != NULL);
-	free(((BcNum*) num)->num);
+
+	BcNum *n = (BcNum*) num;
+
+	assert(n != NULL);
+
+	if (n->cap == BC_NUM_DEF_SIZE && n->num != NULL && BC_VM_MAIN_THREAD &&
+	    vm->pool_len < BC_NUM_POOL)
+	{
+		vm->pool[vm->pool_len++] = n->num;
+	}
+	else free(n->num);
 }
 
 void bc_num_copy(BcNum *d, const BcNum *s) {
@@ -2171,6 +3148,45 @@ size_t bc_num_placesReq(const BcNum *a, const BcNum *b, size_t scale) {
 }
 #endif // BC_ENABLE_EXTRA_MATH
 
+static void bc_num_setSmall(BcNum *c, BcBigDig val, bool neg) {
+
+	bc_num_expand(c, 2);
+
+	c->num[0] = (BcDig) (val % BC_BASE_POW);
+	c->num[1] = (BcDig) (val / BC_BASE_POW);
+	c->len = c->num[1] ? 2 : c->num[0] != 0;
+	c->rdx = c->scale = 0;
+	c->neg = neg && c->len;
+}
+
+void bc_num_smallAdd(const BcNum *a, const BcNum *b, BcNum *c, bool sub) {
+
+	BcBigDig x, y;
+	bool aneg = a->neg, bneg = (b->neg != sub);
+
+	assert(BC_NUM_SMALL(a) && BC_NUM_SMALL(b));
+
+	x = a->len ? (BcBigDig) a->num[0] : 0;
+	y = b->len ? (BcBigDig) b->num[0] : 0;
+
+	if (aneg == bneg) bc_num_setSmall(c, x + y, aneg);
+	else if (x >= y) bc_num_setSmall(c, x - y, aneg);
+	else bc_num_setSmall(c, y - x, bneg);
+}
+
+void bc_num_smallMul(const BcNum *a, const BcNum *b, BcNum *c) {
+
+	BcBigDig x, y;
+	bool neg = (a->neg != b->neg);
+
+	assert(BC_NUM_SMALL(a) && BC_NUM_SMALL(b));
+
+	x = a->len ? (BcBigDig) a->num[0] : 0;
+	y = b->len ? (BcBigDig) b->num[0] : 0;
+
+	bc_num_setSmall(c, x * y, neg);
+}
+
 BcStatus bc_num_add(BcNum *a, BcNum *b, BcNum *c, size_t scale) {
 	return bc_num_binary(a, b, c, false, bc_num_as, bc_num_addReq(a, b, scale));
 }
@@ -2192,6 +3208,36 @@ BcStatus bc_num_mod(BcNum *a, BcNum *b, BcNum *c, size_t scale) {
 	return bc_num_binary(a, b, c, scale, bc_num_rem, req);
 }
 
+BcStatus bc_num_fma(BcNum *a, BcNum *b, BcNum *c, BcNum *restrict d,
+                    size_t scale)
+{
+	BcStatus s;
+
+	assert(a != NULL && b != NULL && c != NULL && d != NULL);
+	assert(d != a && d != b && d != c);
+
+	bc_num_expand(d, bc_num_mulReq(a, b, scale));
+
+	s = bc_num_m(a, b, d, scale);
+	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+
+	// The product stays in d and c is accumulated into it in place, which
+	// needs d to have at least as many fractional limbs as c. Extending is
+	// only necessary (and only correct, for the scale of the result) when
+	// neither is zero; bc_num_as() will set the scale to the max anyway.
+	if (BC_NUM_NONZERO(d) && BC_NUM_NONZERO(c) && d->scale < c->scale)
+		bc_num_extend(d, c->scale - d->scale);
+
+	bc_num_expand(d, bc_num_addReq(d, c, scale));
+
+	s = bc_num_as(d, c, d, false);
+
+	assert(!d->neg || BC_NUM_NONZERO(d));
+	assert(!d->len || d->num[d->len - 1] || d->rdx == d->len);
+
+	return s;
+}
+
 BcStatus bc_num_pow(BcNum *a, BcNum *b, BcNum *c, size_t scale) {
 	return bc_num_binary(a, b, c, scale, bc_num_p, bc_num_powReq(a, b, scale));
 }
@@ -2363,6 +3409,436 @@ BcStatus bc_num_divmod(BcNum *a, BcNum *b, BcNum *c, BcNum *d, size_t scale) {
 	return s;
 }
 
+#if BC_ENABLED
+static size_t bc_num_bits(BcBigDig n) {
+	size_t i;
+	for (i = 0; n; ++i) n >>= 1;
+	return i;
+}
+
+static void bc_num_bsplitInit(BcNumBSplitTask *t, BcNumBSplit *bs,
+                              size_t lo, size_t hi)
+{
+	t->bs = bs;
+	t->lo = lo;
+	t->hi = hi;
+	bc_num_init(&t->p, BC_NUM_DEF_SIZE);
+	bc_num_init(&t->q, BC_NUM_DEF_SIZE);
+	bc_num_init(&t->b, BC_NUM_DEF_SIZE);
+	bc_num_init(&t->t, BC_NUM_DEF_SIZE);
+}
+
+static void bc_num_bsplitFree(BcNumBSplitTask *t) {
+	bc_num_free(&t->t);
+	bc_num_free(&t->b);
+	bc_num_free(&t->q);
+	bc_num_free(&t->p);
+}
+
+// This does binary splitting, from "Fast multiprecision evaluation of series
+// of rational numbers" by Haible and Papanikolaou, on the terms in [lo, hi).
+// The sum of those terms is t / (b * q) times the product of the ratios
+// before lo. The two halves are independent, so big ones are split between
+// threads.
+static BcStatus bc_num_bsplit(void *data) {
+
+	BcStatus s, s2;
+	BcNumBSplitTask *t = (BcNumBSplitTask*) data, l, r;
+	BcNumBSplit *bs = t->bs;
+	BcNum temp;
+	BcVmTask task;
+	size_t mid;
+
+	if (BC_SIG) return BC_STATUS_SIGNAL;
+
+	if (t->hi - t->lo == 1) {
+
+		s = BC_STATUS_SUCCESS;
+
+		if (!t->lo) {
+			bc_num_copy(&t->p, &bs->p0);
+			bc_num_copy(&t->q, &bs->q0);
+		}
+		else {
+
+			bc_num_copy(&t->p, &bs->p);
+			bc_num_copy(&t->q, &bs->q);
+
+			if (bs->fact) {
+				bc_num_bigdig2num(&t->b, (BcBigDig) t->lo);
+				s = bc_num_mul(&t->q, &t->b, &t->q, 0);
+			}
+		}
+
+		if (bs->odd) bc_num_bigdig2num(&t->b, (BcBigDig) (2 * t->lo + 1));
+
+		bc_num_copy(&t->t, &t->p);
+
+		return s;
+	}
+
+	mid = t->lo + (t->hi - t->lo) / 2;
+
+	bc_num_bsplitInit(&l, bs, t->lo, mid);
+	bc_num_bsplitInit(&r, bs, mid, t->hi);
+	bc_num_init(&temp, BC_NUM_DEF_SIZE);
+
+	if (t->hi - t->lo >= BC_NUM_SERIES_THREAD_TERMS) {
+		bc_vm_spawn(&task, bc_num_bsplit, &r);
+		s = bc_num_bsplit(&l);
+		s2 = bc_vm_join(&task);
+		if (BC_NO_ERR(!s)) s = s2;
+	}
+	else {
+		s = bc_num_bsplit(&l);
+		if (BC_NO_ERR(!s)) s = bc_num_bsplit(&r);
+	}
+
+	if (BC_ERR(s)) goto err;
+
+	// t = b(r) * q(r) * t(l) + b(l) * p(l) * t(r)
+	s = bc_num_mul(&r.q, &l.t, &t->t, 0);
+	if (BC_ERR(s)) goto err;
+	s = bc_num_mul(&l.p, &r.t, &temp, 0);
+	if (BC_ERR(s)) goto err;
+
+	if (bs->odd) {
+		s = bc_num_mul(&t->t, &r.b, &t->t, 0);
+		if (BC_ERR(s)) goto err;
+		s = bc_num_mul(&temp, &l.b, &temp, 0);
+		if (BC_ERR(s)) goto err;
+		s = bc_num_mul(&l.b, &r.b, &t->b, 0);
+		if (BC_ERR(s)) goto err;
+	}
+
+	s = bc_num_add(&t->t, &temp, &t->t, 0);
+	if (BC_ERR(s)) goto err;
+	s = bc_num_mul(&l.p, &r.p, &t->p, 0);
+	if (BC_ERR(s)) goto err;
+	s = bc_num_mul(&l.q, &r.q, &t->q, 0);
+
+err:
+	bc_num_free(&temp);
+	bc_num_bsplitFree(&r);
+	bc_num_bsplitFree(&l);
+	return s;
+}
+
+static BcStatus bc_num_bsplitSum(BcNumBSplit *bs, size_t n,
+                                 BcNum *restrict r, size_t scale)
+{
+	BcStatus s;
+	BcNumBSplitTask t;
+
+	bc_num_bsplitInit(&t, bs, 0, n);
+
+	s = bc_num_bsplit(&t);
+	if (BC_ERR(s)) goto err;
+
+	if (bs->odd) {
+		s = bc_num_mul(&t.q, &t.b, &t.q, 0);
+		if (BC_ERR(s)) goto err;
+	}
+
+	s = bc_num_div(&t.t, &t.q, r, scale);
+
+err:
+	bc_num_bsplitFree(&t);
+	return s;
+}
+
+static void bc_num_bsplitFreeSeries(BcNumBSplit *bs) {
+	bc_num_free(&bs->q);
+	bc_num_free(&bs->p);
+	bc_num_free(&bs->q0);
+	bc_num_free(&bs->p0);
+}
+
+// The number of bits needed for an error of less than 10^-scale.
+static size_t bc_num_seriesBits(size_t scale) {
+	return (scale / 3 + 1) * 10;
+}
+
+// This computes e^(x/d) to scale.
+static BcStatus bc_num_expSeries(BcBigDig x, BcBigDig d, BcNum *restrict r,
+                                 size_t scale)
+{
+	BcStatus s;
+	BcNumBSplit bs;
+	BcBigDig c = (x + d - 1) / d;
+	size_t n, need = bc_num_seriesBits(scale), lx = bc_num_bits(c);
+	ssize_t acc = 0;
+
+	// Term n is less than 2^-acc. Once n is more than twice the argument, the
+	// terms at least halve every time, so the rest add up to less than that.
+	for (n = 1; n <= 2 * c || acc < (ssize_t) need; ++n)
+		acc += (ssize_t) bc_num_bits((BcBigDig) n) - 1 - (ssize_t) lx;
+
+	bs.odd = false;
+	bs.fact = true;
+
+	bc_num_createFromBigdig(&bs.p0, 1);
+	bc_num_createFromBigdig(&bs.q0, 1);
+	bc_num_createFromBigdig(&bs.p, x);
+	bc_num_createFromBigdig(&bs.q, d);
+
+	s = bc_num_bsplitSum(&bs, n, r, scale);
+
+	bc_num_bsplitFreeSeries(&bs);
+
+	return s;
+}
+
+// This computes atan(x/d), or atanh(x/d) if hyp is true, to scale. The
+// argument must be in [0, 1/2].
+static BcStatus bc_num_atanSeries(BcBigDig x, BcBigDig d, bool hyp,
+                                  BcNum *restrict r, size_t scale)
+{
+	BcStatus s;
+	BcNumBSplit bs;
+	BcBigDig ratio;
+	size_t bits;
+
+	assert(2 * x <= d);
+
+	if (!x) {
+		bc_num_setToZero(r, scale);
+		return BC_STATUS_SUCCESS;
+	}
+
+	// Every term is smaller than the last by at least (d/x)^2.
+	ratio = d / x;
+	if (bc_num_bits(ratio) <= sizeof(BcBigDig) * CHAR_BIT / 2)
+		bits = bc_num_bits(ratio * ratio) - 1;
+	else bits = 2 * (bc_num_bits(ratio) - 1);
+
+	bs.odd = true;
+	bs.fact = false;
+
+	bc_num_createFromBigdig(&bs.p0, x);
+	bc_num_createFromBigdig(&bs.q0, d);
+	bc_num_init(&bs.p, BC_NUM_DEF_SIZE);
+	bc_num_init(&bs.q, BC_NUM_DEF_SIZE);
+
+	s = bc_num_mul(&bs.p0, &bs.p0, &bs.p, 0);
+	if (BC_ERR(s)) goto err;
+	s = bc_num_mul(&bs.q0, &bs.q0, &bs.q, 0);
+	if (BC_ERR(s)) goto err;
+
+	bs.p.neg = !hyp;
+
+	s = bc_num_bsplitSum(&bs, bc_num_seriesBits(scale) / bits + 2, r, scale);
+
+err:
+	bc_num_bsplitFreeSeries(&bs);
+	return s;
+}
+
+// r += a * m
+static BcStatus bc_num_seriesMulAdd(BcNum *restrict r, BcNum *restrict a,
+                                    ssize_t m)
+{
+	BcStatus s;
+	BcNum num, temp;
+
+	if (!m) return BC_STATUS_SUCCESS;
+
+	bc_num_createFromBigdig(&num, (BcBigDig) (m < 0 ? -m : m));
+	num.neg = (m < 0);
+	bc_num_init(&temp, BC_NUM_DEF_SIZE);
+
+	s = bc_num_mul(a, &num, &temp, 0);
+	if (BC_NO_ERR(!s)) s = bc_num_add(r, &temp, r, 0);
+
+	bc_num_free(&temp);
+	bc_num_free(&num);
+
+	return s;
+}
+
+static BcStatus bc_num_expLib(BcBigDig x, BcBigDig d, bool neg,
+                              BcNum *restrict b, size_t scale)
+{
+	BcStatus s;
+	BcNum r;
+
+	bc_num_init(&r, BC_NUM_DEF_SIZE);
+
+	s = bc_num_expSeries(x, d, &r, scale + BC_NUM_SERIES_GUARD);
+	if (BC_ERR(s)) goto err;
+
+	if (neg) s = bc_num_inv(&r, b, scale);
+	else bc_num_copy(b, &r);
+
+err:
+	bc_num_free(&r);
+	return s;
+}
+
+static BcStatus bc_num_logLib(BcBigDig x, BcBigDig d, BcNum *restrict b,
+                              size_t scale)
+{
+	BcStatus s;
+	BcNum l2, l10, temp;
+	BcBigDig e, i;
+	ssize_t j = 0, m = 0;
+
+	scale += BC_NUM_SERIES_GUARD;
+
+	// x/d = e * 2^m * 10^j / d * y, with y in [1, 2).
+	for (e = 1, i = x; i >= BC_BASE; i /= BC_BASE, ++j) e *= BC_BASE;
+	for (i = d; i >= BC_BASE; i /= BC_BASE) --j;
+	for (; x >= 2 * e; ++m) e *= 2;
+
+	bc_num_init(&l2, BC_NUM_DEF_SIZE);
+	bc_num_init(&l10, BC_NUM_DEF_SIZE);
+	bc_num_init(&temp, BC_NUM_DEF_SIZE);
+
+	// l(y) = 2 * atanh((y - 1) / (y + 1))
+	s = bc_num_atanSeries(x - e, x + e, true, b, scale);
+	if (BC_ERR(s)) goto err;
+	s = bc_num_add(b, b, b, 0);
+	if (BC_ERR(s) || (!m && !j)) goto err;
+
+	// l(2) = 2 * atanh(1/3)
+	s = bc_num_atanSeries(1, 3, true, &l2, scale);
+	if (BC_ERR(s)) goto err;
+	s = bc_num_add(&l2, &l2, &l2, 0);
+	if (BC_ERR(s)) goto err;
+	s = bc_num_seriesMulAdd(b, &l2, m);
+	if (BC_ERR(s) || !j) goto err;
+
+	// l(10) = 3 * l(2) + 2 * atanh(1/9)
+	s = bc_num_atanSeries(1, 9, true, &temp, scale);
+	if (BC_ERR(s)) goto err;
+	s = bc_num_add(&temp, &temp, &l10, 0);
+	if (BC_ERR(s)) goto err;
+	s = bc_num_seriesMulAdd(&l10, &l2, 3);
+	if (BC_ERR(s)) goto err;
+	s = bc_num_seriesMulAdd(b, &l10, j);
+
+err:
+	bc_num_free(&temp);
+	bc_num_free(&l10);
+	bc_num_free(&l2);
+	return s;
+}
+
+static BcStatus bc_num_atanLib(BcBigDig x, BcBigDig d, BcNum *restrict b,
+                               size_t scale)
+{
+	BcStatus s;
+	BcNum r, temp;
+	BcBigDig p = x, q = d;
+	bool inv = (x > d);
+
+	scale += BC_NUM_SERIES_GUARD;
+
+	// a(x) = pi/2 - a(1/x)
+	if (inv) {
+		p = d;
+		q = x;
+	}
+
+	bc_num_init(&r, BC_NUM_DEF_SIZE);
+	bc_num_init(&temp, BC_NUM_DEF_SIZE);
+
+	// a(x) = a(1/2) + a((2x - 1) / (2 + x))
+	if (2 * p > q) {
+		s = bc_num_atanSeries(1, 2, false, b, scale);
+		if (BC_ERR(s)) goto err;
+		s = bc_num_atanSeries(2 * p - q, 2 * q + p, false, &temp, scale);
+		if (BC_ERR(s)) goto err;
+		s = bc_num_add(b, &temp, b, 0);
+	}
+	else s = bc_num_atanSeries(p, q, false, b, scale);
+
+	if (BC_ERR(s) || !inv) goto err;
+
+	// pi/2 = 2 * (a(1/2) + a(1/3))
+	s = bc_num_atanSeries(1, 2, false, &r, scale);
+	if (BC_ERR(s)) goto err;
+	s = bc_num_atanSeries(1, 3, false, &temp, scale);
+	if (BC_ERR(s)) goto err;
+	s = bc_num_add(&r, &temp, &r, 0);
+	if (BC_ERR(s)) goto err;
+	s = bc_num_add(&r, &r, &r, 0);
+	if (BC_ERR(s)) goto err;
+	s = bc_num_sub(&r, b, b, 0);
+
+err:
+	bc_num_free(&temp);
+	bc_num_free(&r);
+	return s;
+}
+
+BcStatus bc_num_series(BcNum *a, BcNum *restrict b, size_t scale, char fn,
+                       bool *done)
+{
+	BcStatus s;
+	BcBigDig x, d, pow;
+	size_t i;
+
+	assert(a != NULL && b != NULL && done != NULL);
+	assert(a != b);
+
+	*done = false;
+
+	// Only arguments with at most one limb of integer and one of fraction are
+	// done here. That makes the argument x/d, where both fit in a BcBigDig.
+	if (BC_NUM_ZERO(a) || bc_num_int(a) > 1 || a->scale > BC_BASE_DIGS)
+		return BC_STATUS_SUCCESS;
+	if (fn == 'l' && a->neg) return BC_STATUS_SUCCESS;
+
+	for (d = 1, i = 0; i < a->scale; ++i) d *= BC_BASE;
+
+	x = bc_num_int(a) ? (BcBigDig) a->num[a->rdx] * d : 0;
+
+	if (a->rdx) {
+		pow = BC_BASE_POW / d;
+		if ((BcBigDig) a->num[0] % pow) return BC_STATUS_SUCCESS;
+		x += (BcBigDig) a->num[0] / pow;
+	}
+
+	switch (fn) {
+
+		case 'e':
+		{
+			if (x > BC_NUM_SERIES_EXP_MAX * d) return BC_STATUS_SUCCESS;
+			s = bc_num_expLib(x, d, a->neg, b, scale);
+			break;
+		}
+
+		case 'l':
+		{
+			s = bc_num_logLib(x, d, b, scale);
+			break;
+		}
+
+		case 'a':
+		{
+			s = bc_num_atanLib(x, d, b, scale);
+			b->neg = (a->neg && BC_NUM_NONZERO(b));
+			break;
+		}
+
+		default:
+		{
+			return BC_STATUS_SUCCESS;
+		}
+	}
+
+	if (BC_ERR(s)) return s;
+
+	if (b->scale > scale) bc_num_truncate(b, b->scale - scale);
+	else bc_num_extend(b, scale - b->scale);
+
+	*done = true;
+
+	return BC_STATUS_SUCCESS;
+}
+#endif // BC_ENABLED
+
 #if DC_ENABLED
 BcStatus bc_num_modexp(BcNum *a, BcNum *b, BcNum *c, BcNum *restrict d) {
 
@@ -82,7 +82,8 @@ void bc_parse_addId(BcParse *p, const char *string, uchar inst) {
 		}
 	}
 	else {
-		char *str = bc_vm_strdup(string);
+		BcStr str;
+		bc_str_init(&str, bc_vm_strdup(string));
 		bc_vec_push(v, &str);
 	}
 
@@ -140,6 +141,7 @@ BcStatus bc_parse_reset(BcParse *p, BcStatus s) {
 		bc_vec_npop(&p->flags, p->flags.len - 1);
 		bc_vec_npop(&p->exits, p->exits.len);
 		bc_vec_npop(&p->conds, p->conds.len);
+		bc_vec_npop(&p->loops, p->loops.len);
 		bc_vec_npop(&p->ops, p->ops.len);
 	}
 #endif // BC_ENABLED
@@ -156,6 +158,7 @@ void bc_parse_free(BcParse *p) {
 		bc_vec_free(&p->flags);
 		bc_vec_free(&p->exits);
 		bc_vec_free(&p->conds);
+		bc_vec_free(&p->loops);
 		bc_vec_free(&p->ops);
 		bc_vec_free(&p->buf);
 	}
@@ -178,6 +181,7 @@ void bc_parse_init(BcParse *p, BcProgram *prog, size_t func) {
 		bc_vec_push(&p->flags, &flag);
 		bc_vec_init(&p->exits, sizeof(BcInstPtr), NULL);
 		bc_vec_init(&p->conds, sizeof(size_t), NULL);
+		bc_vec_init(&p->loops, sizeof(BcParseLoop), NULL);
 		bc_vec_init(&p->ops, sizeof(BcLexType), NULL);
 		bc_vec_init(&p->buf, sizeof(char), NULL);
 	}
@@ -45,21 +45,25 @@
 #include <vm.h>
 
 #ifndef BC_PROG_NO_STACK_CHECK
-static BcStatus bc_program_checkStack(const BcVec *v, size_t n) {
+static BcStatus bc_program_checkStack(const BcProgram *p, size_t n) {
 #if DC_ENABLED
-	if (!BC_IS_BC && BC_ERR(!BC_PROG_STACK(v, n)))
+	if (p->checks && BC_ERR(!BC_PROG_STACK(&p->results, n)))
 		return bc_vm_err(BC_ERROR_EXEC_STACK);
 #endif // DC_ENABLED
-	assert(BC_PROG_STACK(v, n));
+	assert(BC_PROG_STACK(&p->results, n));
 	return BC_STATUS_SUCCESS;
 }
 #endif // BC_PROG_NO_STACK_CHECK
 
-static BcStatus bc_program_type_num(BcResult *r, BcNum *n) {
+static BcStatus bc_program_type_num(const BcProgram *p,
+                                    BcResult *r, BcNum *n)
+{
 #if BC_ENABLED
 	assert(r->t != BC_RESULT_VOID);
 #endif // BC_ENABLED
-	if (BC_ERR(!BC_PROG_NUM(r, n))) return bc_vm_err(BC_ERROR_EXEC_TYPE);
+	if (p->checks && BC_ERR(!BC_PROG_NUM(r, n)))
+		return bc_vm_err(BC_ERROR_EXEC_TYPE);
+	assert(BC_PROG_NUM(r, n));
 	return BC_STATUS_SUCCESS;
 }
 
@@ -92,9 +96,13 @@ static BcConst* bc_program_const(const BcProgram *p, size_t idx) {
 	return bc_vec_item(&f->consts, idx);
 }
 
-static char* bc_program_str(const BcProgram *p, size_t idx) {
+static BcStr* bc_program_string(const BcProgram *p, size_t idx) {
 	BcFunc *f = bc_program_func(p);
-	return *((char**) bc_vec_item(&f->strs, idx));
+	return bc_vec_item(&f->strs, idx);
+}
+
+static char* bc_program_str(const BcProgram *p, size_t idx) {
+	return bc_program_string(p, idx)->val;
 }
 
 static size_t bc_program_index(const char *restrict code, size_t *restrict bgn)
@@ -166,6 +174,33 @@ static BcVec* bc_program_vec(const BcProgram *p, size_t idx, BcType type) {
 	return bc_vec_item(v, idx);
 }
 
+// Makes sure that the number of a constant is parsed in the current ibase.
+static BcStatus bc_program_constNum(BcProgram *p, BcConst *c) {
+
+	BcStatus s = BC_STATUS_SUCCESS;
+	BcBigDig base = BC_PROG_IBASE(p);
+
+	if (c->base != base) {
+
+		if (c->num.num == NULL)
+			bc_num_init(&c->num, BC_NUM_RDX(strlen(c->val)));
+
+		s = bc_num_parse(&c->num, c->val, base, !c->val[1]);
+		assert(!s || s == BC_STATUS_SIGNAL);
+
+#if BC_ENABLE_SIGNALS
+		// bc_num_parse() should only do operations that can
+		// only fail when signals happen. Thus, if signals
+		// are not enabled, we don't need this check.
+		if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+#endif // BC_ENABLE_SIGNALS
+
+		c->base = base;
+	}
+
+	return s;
+}
+
 static BcStatus bc_program_num(BcProgram *p, BcResult *r, BcNum **num) {
 
 	BcStatus s = BC_STATUS_SUCCESS;
@@ -176,25 +211,9 @@ static BcStatus bc_program_num(BcProgram *p, BcResult *r, BcNum **num) {
 		case BC_RESULT_CONSTANT:
 		{
 			BcConst *c = bc_program_const(p, r->d.loc.loc);
-			BcBigDig base = BC_PROG_IBASE(p);
-
-			if (c->base != base) {
-
-				if (c->num.num == NULL)
-					bc_num_init(&c->num, BC_NUM_RDX(strlen(c->val)));
-
-				s = bc_num_parse(&c->num, c->val, base, !c->val[1]);
-				assert(!s || s == BC_STATUS_SIGNAL);
 
-#if BC_ENABLE_SIGNALS
-				// bc_num_parse() should only do operations that can
-				// only fail when signals happen. Thus, if signals
-				// are not enabled, we don't need this check.
-				if (BC_ERROR_SIGNAL_ONLY(s)) return s;
-#endif // BC_ENABLE_SIGNALS
-
-				c->base = base;
-			}
+			s = bc_program_constNum(p, c);
+			if (BC_ERROR_SIGNAL_ONLY(s)) return s;
 
 			n = &r->d.n;
 			bc_num_createCopy(n, &c->num);
@@ -278,7 +297,7 @@ static BcStatus bc_program_operand(BcProgram *p, BcResult **r,
                                    BcNum **n, size_t idx)
 {
 #ifndef BC_PROG_NO_STACK_CHECK
-	BcStatus s = bc_program_checkStack(&p->results, idx + 1);
+	BcStatus s = bc_program_checkStack(p, idx + 1);
 
 	if (BC_ERR(s)) return s;
 #endif // BC_PROG_NO_STACK_CHECK
@@ -293,6 +312,28 @@ static BcStatus bc_program_operand(BcProgram *p, BcResult **r,
 	return bc_program_num(p, *r, n);
 }
 
+// Both operands of binary operators and assignments are popped as soon as the
+// operation is done, so constants are used in place instead of being copied.
+static BcStatus bc_program_binOperand(BcProgram *p, BcResult **r,
+                                      BcNum **n, size_t idx)
+{
+#ifndef BC_PROG_NO_STACK_CHECK
+	BcStatus s = bc_program_checkStack(p, idx + 1);
+
+	if (BC_ERR(s)) return s;
+#endif // BC_PROG_NO_STACK_CHECK
+
+	*r = bc_vec_item_rev(&p->results, idx);
+
+	if ((*r)->t == BC_RESULT_CONSTANT) {
+		BcConst *c = bc_program_const(p, (*r)->d.loc.loc);
+		*n = &c->num;
+		return bc_program_constNum(p, c);
+	}
+
+	return bc_program_operand(p, r, n, idx);
+}
+
 static BcStatus bc_program_binPrep(BcProgram *p, BcResult **l, BcNum **ln,
                                    BcResult **r, BcNum **rn)
 {
@@ -301,9 +342,9 @@ static BcStatus bc_program_binPrep(BcProgram *p, BcResult **l, BcNum **ln,
 
 	assert(p != NULL && l != NULL && ln != NULL && r != NULL && rn != NULL);
 
-	s = bc_program_operand(p, l, ln, 1);
+	s = bc_program_binOperand(p, l, ln, 1);
 	if (BC_ERR(s)) return s;
-	s = bc_program_operand(p, r, rn, 0);
+	s = bc_program_binOperand(p, r, rn, 0);
 	if (BC_ERR(s)) return s;
 
 	lt = (*l)->t;
@@ -317,7 +358,7 @@ static BcStatus bc_program_binPrep(BcProgram *p, BcResult **l, BcNum **ln,
 	if (lt == (*r)->t && (lt == BC_RESULT_VAR || lt == BC_RESULT_ARRAY_ELEM))
 		s = bc_program_num(p, *l, ln);
 
-	if (BC_NO_ERR(!s) && BC_ERR(lt == BC_RESULT_STR))
+	if (BC_NO_ERR(!s) && p->checks && BC_ERR(lt == BC_RESULT_STR))
 		return bc_vm_err(BC_ERROR_EXEC_TYPE);
 
 	return s;
@@ -331,10 +372,10 @@ static BcStatus bc_program_binOpPrep(BcProgram *p, BcResult **l, BcNum **ln,
 	s = bc_program_binPrep(p, l, ln, r, rn);
 	if (BC_ERR(s)) return s;
 
-	s = bc_program_type_num(*l, *ln);
+	s = bc_program_type_num(p, *l, *ln);
 	if (BC_ERR(s)) return s;
 
-	return bc_program_type_num(*r, *rn);
+	return bc_program_type_num(p, *r, *rn);
 }
 
 static BcStatus bc_program_assignPrep(BcProgram *p, BcResult **l, BcNum **ln,
@@ -367,7 +408,7 @@ static BcStatus bc_program_assignPrep(BcProgram *p, BcResult **l, BcNum **ln,
 	assert((*r)->t != BC_RESULT_STR);
 #endif // DC_ENABLED
 
-	if (!good) s = bc_program_type_num(*r, *rn);
+	if (!good) s = bc_program_type_num(p, *r, *rn);
 
 	return s;
 }
@@ -392,7 +433,7 @@ static BcStatus bc_program_prep(BcProgram *p, BcResult **r, BcNum **n) {
 	assert((*r)->t != BC_RESULT_VAR || !BC_PROG_STR(*n));
 #endif // DC_ENABLED
 
-	return bc_program_type_num(*r, *n);
+	return bc_program_type_num(p, *r, *n);
 }
 
 static void bc_program_retire(BcProgram *p, BcResult *r, BcResultType t) {
@@ -410,10 +451,23 @@ static BcStatus bc_program_op(BcProgram *p, uchar inst) {
 
 	s = bc_program_binOpPrep(p, &opd1, &n1, &opd2, &n2);
 	if (BC_ERR(s)) return s;
-	bc_num_init(&res.d.n, bc_program_opReqs[idx](n1, n2, BC_PROG_SCALE(p)));
 
-	s = bc_program_ops[idx](n1, n2, &res.d.n, BC_PROG_SCALE(p));
-	if (BC_ERR(s)) goto err;
+	if (BC_PROG_SMALL_OP(inst) && BC_NUM_SMALL(n1) && BC_NUM_SMALL(n2)) {
+
+		bc_num_init(&res.d.n, BC_NUM_DEF_SIZE);
+
+		if (inst == BC_INST_MULTIPLY) bc_num_smallMul(n1, n2, &res.d.n);
+		else bc_num_smallAdd(n1, n2, &res.d.n, inst == BC_INST_MINUS);
+	}
+	else {
+
+		bc_num_init(&res.d.n,
+		            bc_program_opReqs[idx](n1, n2, BC_PROG_SCALE(p)));
+
+		s = bc_program_ops[idx](n1, n2, &res.d.n, BC_PROG_SCALE(p));
+		if (BC_ERR(s)) goto err;
+	}
+
 	bc_program_binOpRetire(p, &res);
 
 	return s;
@@ -423,598 +477,1772 @@ err:
 	return s;
 }
 
-static BcStatus bc_program_read(BcProgram *p) {
-
-	BcStatus s;
-	BcParse parse;
-	BcVec buf;
-	BcInstPtr ip;
-	size_t i;
-	const char* file;
-	BcFunc *f = bc_vec_item(&p->fns, BC_PROG_READ);
-
-	for (i = 0; i < p->stack.len; ++i) {
-		BcInstPtr *ip_ptr = bc_vec_item(&p->stack, i);
-		if (ip_ptr->func == BC_PROG_READ)
-			return bc_vm_err(BC_ERROR_EXEC_REC_READ);
-	}
+// Pushes the constant or variable between a multiply and the add that it is
+// fused with.
+static void bc_program_fmaOperand(BcProgram *p, const char *code, size_t *bgn) {
 
-	file = vm->file;
-	bc_lex_file(&parse.l, bc_program_stdin_name);
-	bc_vec_npop(&f->code, f->code.len);
-	bc_vec_init(&buf, sizeof(char), NULL);
+	BcResult r;
+	uchar inst = (uchar) code[(*bgn)++];
 
-	s = bc_read_line(&buf, BC_IS_BC ? "read> " : "?> ");
-	if (BC_ERR(s)) {
-		if (s == BC_STATUS_EOF) s = bc_vm_err(BC_ERROR_EXEC_READ_EXPR);
-		goto io_err;
+	if (inst != BC_INST_ONE) {
+		r.t = inst == BC_INST_NUM ? BC_RESULT_CONSTANT : BC_RESULT_VAR;
+		r.d.loc.loc = bc_program_index(code, bgn);
 	}
+	else r.t = BC_RESULT_ONE;
 
-	bc_parse_init(&parse, p, BC_PROG_READ);
+	bc_vec_push(&p->results, &r);
+}
 
-	s = bc_parse_text(&parse, buf.v);
-	if (BC_ERR(s)) goto exec_err;
-	s = vm->expr(&parse, BC_PARSE_NOREAD | BC_PARSE_NEEDVAL);
-	if (BC_ERR(s)) goto exec_err;
+// Multiplies the two results that are not the addend and adds the addend to
+// the product. The addend is either under them, for c + a * b, or on top of
+// them, for a * b + c.
+static BcStatus bc_program_fma(BcProgram *p, size_t addend) {
 
-	if (BC_ERR(parse.l.t != BC_LEX_NLINE && parse.l.t != BC_LEX_EOF)) {
-		s = bc_vm_err(BC_ERROR_EXEC_READ_EXPR);
-		goto exec_err;
-	}
+	BcStatus s;
+	BcResult *r1, *r2, *r3, res;
+	BcNum *n1, *n2, *n3;
+	size_t top = !addend;
 
-	if (BC_G) bc_program_prepGlobals(p);
+	s = bc_program_binOperand(p, &r1, &n1, addend);
+	if (BC_ERR(s)) return s;
+	s = bc_program_type_num(p, r1, n1);
+	if (BC_ERR(s)) return s;
 
-	ip.func = BC_PROG_READ;
-	ip.idx = 0;
-	ip.len = p->results.len;
+	s = bc_program_binOperand(p, &r2, &n2, top + 1);
+	if (BC_ERR(s)) return s;
+	s = bc_program_type_num(p, r2, n2);
+	if (BC_ERR(s)) return s;
 
-	// Update this pointer, just in case.
-	f = bc_vec_item(&p->fns, BC_PROG_READ);
+	s = bc_program_binOperand(p, &r3, &n3, top);
+	if (BC_ERR(s)) return s;
+	s = bc_program_type_num(p, r3, n3);
+	if (BC_ERR(s)) return s;
 
-	bc_vec_pushByte(&f->code, vm->read_ret);
-	bc_vec_push(&p->stack, &ip);
-#if DC_ENABLED
-	if (!BC_IS_BC) {
-		size_t temp = 0;
-		bc_vec_push(&p->tail_calls, &temp);
+	// Make sure that the values have their pointers updated, if necessary.
+	if (r1->t == BC_RESULT_VAR || r1->t == BC_RESULT_ARRAY_ELEM) {
+		if (r1->t == r2->t || r1->t == r3->t) {
+			s = bc_program_num(p, r1, &n1);
+			if (BC_ERR(s)) return s;
+		}
 	}
-#endif // DC_ENABLED
 
-exec_err:
-	bc_parse_free(&parse);
-io_err:
-	bc_vec_free(&buf);
-	vm->file = file;
-	return s;
-}
+	if (r2->t == BC_RESULT_VAR || r2->t == BC_RESULT_ARRAY_ELEM) {
+		if (r2->t == r3->t) {
+			s = bc_program_num(p, r2, &n2);
+			if (BC_ERR(s)) return s;
+		}
+	}
 
-static void bc_program_printChars(const char *str) {
-	const char *nl;
-	vm->nchars += bc_vm_printf("%s", str);
-	nl = strrchr(str, '\n');
-	if (nl) vm->nchars = strlen(nl + 1);
-}
+	bc_num_init(&res.d.n, BC_NUM_DEF_SIZE);
 
-static void bc_program_printString(const char *restrict str) {
+	s = bc_num_fma(n2, n3, n1, &res.d.n, BC_PROG_SCALE(p));
+	if (BC_ERR(s)) goto err;
 
-	size_t i, len = strlen(str);
+	bc_vec_pop(&p->results);
+	bc_program_binOpRetire(p, &res);
 
-#if DC_ENABLED
-	if (!len && !BC_IS_BC) {
-		bc_vm_putchar('\0');
-		return;
-	}
-#endif // DC_ENABLED
+	return s;
 
-	for (i = 0; i < len; ++i) {
+err:
+	bc_num_free(&res.d.n);
+	return s;
+}
 
-		int c = str[i];
+// Returns whether there are at least n results and the top nums are numbers.
+static bool bc_program_verifyNums(const BcVec *types, size_t n, size_t nums) {
 
-		if (c == '\\' && i != len - 1) {
+	size_t i;
 
-			const char *ptr;
+	if (types->len < n) return false;
 
-			c = str[++i];
-			ptr = strchr(bc_program_esc_chars, c);
+	for (i = 0; i < nums; ++i) {
+		if (BC_PROG_TYPE(types, i) != BC_PROG_TYPE_NUM) return false;
+	}
 
-			if (ptr != NULL) {
-				if (c == 'n') vm->nchars = SIZE_MAX;
-				c = bc_program_esc_seqs[(size_t) (ptr - bc_program_esc_chars)];
-			}
-			else {
-				// Just print the backslash. The following
-				// character will be printed later.
-				bc_vm_putchar('\\');
-			}
-		}
+	return true;
+}
 
-		bc_vm_putchar(c);
-	}
+// Does what bc_program_verifyNums() does, and pops the n results if it is true.
+static bool bc_program_verifyPop(BcVec *types, size_t n, size_t nums) {
+	bool good = bc_program_verifyNums(types, n, nums);
+	if (good) bc_vec_npop(types, n);
+	return good;
 }
 
-static BcStatus bc_program_print(BcProgram *p, uchar inst, size_t idx) {
+#if BC_ENABLED
+// Returns whether a jump to a label agrees with the depth that every other way
+// to get there has. Labels that were passed already have a depth, and the
+// first jump to one that was not gives it one.
+static bool bc_program_verifyJump(const BcFunc *f, BcVec *depths,
+                                  size_t bgn, size_t label, size_t depth)
+{
+	size_t addr, *ptr;
 
-	BcStatus s = BC_STATUS_SUCCESS;
-	BcResult *r;
-	char *str;
-	BcNum *n;
-	bool pop = (inst != BC_INST_PRINT);
+	if (label >= f->labels.len) return false;
 
-	assert(p != NULL);
+	addr = *((size_t*) bc_vec_item(&f->labels, label));
+	if (addr == SIZE_MAX || addr < bgn || addr > f->code.len) return false;
 
-#ifndef BC_PROG_NO_STACK_CHECK
-	s = bc_program_checkStack(&p->results, idx + 1);
-	if (BC_ERR(s)) return s;
-#endif // BC_PROG_NO_STACK_CHECK
+	ptr = bc_vec_item(depths, addr - bgn);
+	if (*ptr == BC_PROG_DEPTH_LABEL) *ptr = depth;
 
-	r = bc_vec_item_rev(&p->results, idx);
+	return *ptr == depth;
+}
+#endif // BC_ENABLED
 
+// Simulates the results stack over the code of f from bgn on, and returns
+// whether no instruction can use more results than were pushed before it and
+// whether every operand that has to be a number is. This lets the code run
+// without checks. The instructions that run a string in dc end the proof,
+// and they turn the checks back on for the rest of the code.
+static bool bc_program_verify(const BcFunc *f, size_t bgn) {
+
+	const char *code = f->code.v;
+	size_t i = bgn, n;
+	BcVec types;
+	uchar t;
+	bool good = true, done = false;
 #if BC_ENABLED
-	if (r->t == BC_RESULT_VOID) {
-		if (BC_ERR(pop)) return bc_vm_err(BC_ERROR_EXEC_VOID_VAL);
-		bc_vec_pop(&p->results);
-		return s;
-	}
+	BcVec depths;
+	size_t *ptr, start, depth = BC_PROG_DEPTH_NONE;
+	bool reach = true, dead = false;
 #endif // BC_ENABLED
 
-	s = bc_program_num(p, r, &n);
-	if (BC_ERR(s)) return s;
+	bc_vec_init(&types, sizeof(uchar), NULL);
 
-	if (BC_PROG_NUM(r, n)) {
-		assert(inst != BC_INST_PRINT_STR);
-		s = bc_num_print(n, BC_PROG_OBASE(p), !pop);
 #if BC_ENABLED
-		if (BC_NO_ERR(!s) && BC_IS_BC) bc_num_copy(&p->last, n);
-#endif // BC_ENABLED
-	}
-	else {
-
-		size_t i = (r->t == BC_RESULT_STR) ? r->d.loc.loc : n->scale;
+	bc_vec_init(&depths, sizeof(size_t), NULL);
+	if (BC_IS_BC) {
 
-		str = bc_program_str(p, i);
+		for (n = bgn; n <= f->code.len; ++n) bc_vec_push(&depths, &depth);
 
-		if (inst == BC_INST_PRINT_STR) bc_program_printChars(str);
-		else {
-			bc_program_printString(str);
-			if (inst == BC_INST_PRINT) bc_vm_putchar('\n');
+		for (n = 0; n < f->labels.len; ++n) {
+			size_t addr = *((size_t*) bc_vec_item(&f->labels, n));
+			if (addr < bgn || addr > f->code.len) continue;
+			ptr = bc_vec_item(&depths, addr - bgn);
+			*ptr = BC_PROG_DEPTH_LABEL;
 		}
 	}
+#endif // BC_ENABLED
 
-	if (BC_NO_ERR(!s) && (BC_IS_BC || pop)) bc_vec_pop(&p->results);
-
-	return s;
-}
-
-void bc_program_negate(BcResult *r, BcNum *n) {
-	BcNum *rn = &r->d.n;
-	bc_num_copy(rn, n);
-	if (BC_NUM_NONZERO(rn)) rn->neg = !rn->neg;
-}
-
-void bc_program_not(BcResult *r, BcNum *n) {
-	if (!bc_num_cmpZero(n)) bc_num_one(&r->d.n);
-}
-
-#if BC_ENABLE_EXTRA_MATH
-void bc_program_trunc(BcResult *r, BcNum *n) {
-	BcNum *rn = &r->d.n;
-	bc_num_copy(rn, n);
-	bc_num_truncate(rn, n->scale);
-}
-#endif // BC_ENABLE_EXTRA_MATH
-
-static BcStatus bc_program_unary(BcProgram *p, uchar inst) {
-
-	BcStatus s;
-	BcResult res, *ptr;
-	BcNum *num;
-
-	s = bc_program_prep(p, &ptr, &num);
-	if (BC_ERR(s)) return s;
-
-	bc_num_init(&res.d.n, num->len);
-	bc_program_unarys[inst - BC_INST_NEG](&res, num);
-	bc_program_retire(p, &res, BC_RESULT_TEMP);
+	while (good && !done && i < f->code.len) {
 
-	return s;
-}
+		uchar inst;
 
-static BcStatus bc_program_logical(BcProgram *p, uchar inst) {
+#if BC_ENABLED
+		start = i;
 
-	BcStatus s;
-	BcResult *opd1, *opd2, res;
-	BcNum *n1, *n2;
-	bool cond = 0;
-	ssize_t cmp;
+		if (BC_IS_BC) {
 
-	s = bc_program_binOpPrep(p, &opd1, &n1, &opd2, &n2);
-	if (BC_ERR(s)) return s;
+			// Code after a jump or a return can only be reached by jumping to
+			// a label. Only caches jump with results, and they do not jump
+			// there, so a label there starts with none. Code that has no label
+			// there is never run, so it does not have to be proven.
+			ptr = bc_vec_item(&depths, start - bgn);
+			dead = (!reach && *ptr == BC_PROG_DEPTH_NONE);
 
-	if (inst == BC_INST_BOOL_AND)
-		cond = (bc_num_cmpZero(n1) && bc_num_cmpZero(n2));
-	else if (inst == BC_INST_BOOL_OR)
-		cond = (bc_num_cmpZero(n1) || bc_num_cmpZero(n2));
-	else {
+			if (!reach) {
+				if (*ptr == BC_PROG_DEPTH_LABEL) *ptr = 0;
+				good = (dead || *ptr == 0);
+				bc_vec_npop(&types, types.len);
+			}
+			else if (*ptr >= BC_PROG_DEPTH_LABEL) *ptr = types.len;
+			else good = (*ptr == types.len);
 
-		cmp = bc_num_cmp(n1, n2);
+			reach = true;
+			if (!good) break;
+		}
+#endif // BC_ENABLED
 
-#if BC_ENABLE_SIGNALS
-		if (BC_NUM_CMP_SIGNAL(cmp)) return BC_STATUS_SIGNAL;
-#endif // BC_ENABLE_SIGNALS
+		inst = (uchar) code[i++];
 
 		switch (inst) {
 
-			case BC_INST_REL_EQ:
+			case BC_INST_NUM:
+			case BC_INST_STR:
 			{
-				cond = (cmp == 0);
+				bc_program_index(code, &i);
+				t = inst == BC_INST_NUM ? BC_PROG_TYPE_NUM : BC_PROG_TYPE_STR;
+				bc_vec_pushByte(&types, t);
 				break;
 			}
 
-			case BC_INST_REL_LE:
+			case BC_INST_VAR:
 			{
-				cond = (cmp <= 0);
+				bc_program_index(code, &i);
+#if DC_ENABLED
+				t = BC_IS_BC ? BC_PROG_TYPE_NUM : BC_PROG_TYPE_REG;
+#else // DC_ENABLED
+				t = BC_PROG_TYPE_NUM;
+#endif // DC_ENABLED
+				bc_vec_pushByte(&types, t);
 				break;
 			}
 
-			case BC_INST_REL_GE:
+			case BC_INST_ARRAY_ELEM:
 			{
-				cond = (cmp >= 0);
+				bc_program_index(code, &i);
+				good = bc_program_verifyPop(&types, 1, 1);
+#if DC_ENABLED
+				t = BC_IS_BC ? BC_PROG_TYPE_NUM : BC_PROG_TYPE_REG;
+#else // DC_ENABLED
+				t = BC_PROG_TYPE_NUM;
+#endif // DC_ENABLED
+				bc_vec_pushByte(&types, t);
 				break;
 			}
 
-			case BC_INST_REL_NE:
+#if BC_ENABLED
+			case BC_INST_ARRAY:
 			{
-				cond = (cmp != 0);
+				bc_program_index(code, &i);
+				bc_vec_pushByte(&types, BC_PROG_TYPE_ARRAY);
 				break;
 			}
 
-			case BC_INST_REL_LT:
+			case BC_INST_LAST:
+#endif // BC_ENABLED
+			case BC_INST_ONE:
+			case BC_INST_IBASE:
+			case BC_INST_OBASE:
+			case BC_INST_SCALE:
+			case BC_INST_MAXIBASE:
+			case BC_INST_MAXOBASE:
+			case BC_INST_MAXSCALE:
+			{
+				bc_vec_pushByte(&types, BC_PROG_TYPE_NUM);
+				break;
+			}
+
+			case BC_INST_LENGTH:
+			case BC_INST_SCALE_FUNC:
+			{
+				// Strings have a length and a scale, but in bc, only length()
+				// takes an array.
+				n = (BC_IS_BC && inst != BC_INST_LENGTH);
+				good = bc_program_verifyPop(&types, 1, n);
+				bc_vec_pushByte(&types, BC_PROG_TYPE_NUM);
+				break;
+			}
+
+#if BC_ENABLED
+			case BC_INST_INC_POST:
+			case BC_INST_DEC_POST:
+			case BC_INST_INC_PRE:
+			case BC_INST_DEC_PRE:
+#endif // BC_ENABLED
+			case BC_INST_NEG:
+			case BC_INST_BOOL_NOT:
+#if BC_ENABLE_EXTRA_MATH
+			case BC_INST_TRUNC:
+#endif // BC_ENABLE_EXTRA_MATH
+			case BC_INST_SQRT:
+			case BC_INST_ABS:
+			{
+				good = bc_program_verifyNums(&types, 1, 1);
+				break;
+			}
+
+			case BC_INST_POWER:
+			case BC_INST_MULTIPLY:
+			case BC_INST_DIVIDE:
+			case BC_INST_MODULUS:
+			case BC_INST_PLUS:
+			case BC_INST_MINUS:
+#if BC_ENABLE_EXTRA_MATH
+			case BC_INST_PLACES:
+			case BC_INST_LSHIFT:
+			case BC_INST_RSHIFT:
+#endif // BC_ENABLE_EXTRA_MATH
+			case BC_INST_REL_EQ:
+			case BC_INST_REL_LE:
+			case BC_INST_REL_GE:
+			case BC_INST_REL_NE:
+			case BC_INST_REL_LT:
+			case BC_INST_REL_GT:
+			case BC_INST_BOOL_OR:
+			case BC_INST_BOOL_AND:
+#if BC_ENABLED
+			case BC_INST_ASSIGN_POWER:
+			case BC_INST_ASSIGN_MULTIPLY:
+			case BC_INST_ASSIGN_DIVIDE:
+			case BC_INST_ASSIGN_MODULUS:
+			case BC_INST_ASSIGN_PLUS:
+			case BC_INST_ASSIGN_MINUS:
+#if BC_ENABLE_EXTRA_MATH
+			case BC_INST_ASSIGN_PLACES:
+			case BC_INST_ASSIGN_LSHIFT:
+			case BC_INST_ASSIGN_RSHIFT:
+#endif // BC_ENABLE_EXTRA_MATH
+			case BC_INST_ASSIGN:
+#endif // BC_ENABLED
+			{
+				good = bc_program_verifyPop(&types, 2, 2);
+				bc_vec_pushByte(&types, BC_PROG_TYPE_NUM);
+				break;
+			}
+
+#if BC_ENABLED
+			case BC_INST_INC_NO_VAL:
+			case BC_INST_DEC_NO_VAL:
+			{
+				good = bc_program_verifyPop(&types, 1, 1);
+				break;
+			}
+
+			case BC_INST_ASSIGN_POWER_NO_VAL:
+			case BC_INST_ASSIGN_MULTIPLY_NO_VAL:
+			case BC_INST_ASSIGN_DIVIDE_NO_VAL:
+			case BC_INST_ASSIGN_MODULUS_NO_VAL:
+			case BC_INST_ASSIGN_PLUS_NO_VAL:
+			case BC_INST_ASSIGN_MINUS_NO_VAL:
+#if BC_ENABLE_EXTRA_MATH
+			case BC_INST_ASSIGN_PLACES_NO_VAL:
+			case BC_INST_ASSIGN_LSHIFT_NO_VAL:
+			case BC_INST_ASSIGN_RSHIFT_NO_VAL:
+#endif // BC_ENABLE_EXTRA_MATH
+#endif // BC_ENABLED
+			case BC_INST_ASSIGN_NO_VAL:
+			{
+				good = bc_program_verifyNums(&types, 2, 2);
+#if DC_ENABLED
+				// A dc register can be assigned a string.
+				if (!good && !BC_IS_BC && bc_program_verifyNums(&types, 2, 0))
+					good = (BC_PROG_TYPE(&types, 1) == BC_PROG_TYPE_REG);
+#endif // DC_ENABLED
+				if (good) bc_vec_npop(&types, 2);
+				break;
+			}
+
+			case BC_INST_PRINT:
+			case BC_INST_PRINT_POP:
+			case BC_INST_PRINT_STR:
+			case BC_INST_POP:
+			{
+				good = bc_program_verifyNums(&types, 1, 0);
+#if BC_ENABLED
+				good = good && BC_PROG_TYPE(&types, 0) != BC_PROG_TYPE_ARRAY;
+#endif // BC_ENABLED
+				if (good && (BC_IS_BC || inst != BC_INST_PRINT))
+					bc_vec_pop(&types);
+				break;
+			}
+
+#if BC_ENABLED
+			case BC_INST_JUMP_ZERO:
+			{
+				good = bc_program_verifyPop(&types, 1, 1);
+			}
+			// Fallthrough.
+			case BC_INST_JUMP:
+			{
+				n = bc_program_index(code, &i);
+				good = good && bc_program_verifyJump(f, &depths, bgn,
+				                                     n, types.len);
+				reach = (inst != BC_INST_JUMP);
+				break;
+			}
+
+			case BC_INST_CALL:
+			{
+				n = bc_program_index(code, &i);
+				bc_program_index(code, &i);
+				good = bc_program_verifyPop(&types, n, 0);
+				bc_vec_pushByte(&types, BC_PROG_TYPE_NUM);
+				break;
+			}
+
+			case BC_INST_RET:
+			{
+				good = bc_program_verifyNums(&types, 1, 1);
+			}
+			// Fallthrough.
+			case BC_INST_RET0:
+			case BC_INST_RET_VOID:
+			case BC_INST_HALT:
+			{
+				reach = false;
+				break;
+			}
+
+			case BC_INST_CACHE:
+			{
+				// If the value is cached, it is pushed and the code that
+				// computes it is jumped over.
+				bc_program_index(code, &i);
+				n = bc_program_index(code, &i);
+				good = bc_program_verifyJump(f, &depths, bgn,
+				                             n, types.len + 1);
+				break;
+			}
+
+			case BC_INST_CACHE_SAVE:
+			{
+				bc_program_index(code, &i);
+				good = bc_program_verifyNums(&types, 1, 1);
+				break;
+			}
+
+			case BC_INST_CACHE_CLEAR:
+			{
+				bc_program_index(code, &i);
+				break;
+			}
+
+			case BC_INST_GLOBAL_SAVE:
+			case BC_INST_GLOBAL_RESTORE:
+			case BC_INST_GLOBAL_SET:
+			{
+				bc_program_index(code, &i);
+				bc_program_index(code, &i);
+				break;
+			}
+#endif // BC_ENABLED
+
+			case BC_INST_READ:
+			{
+				// In bc, read() is an expression. In dc, it runs a string.
+#if DC_ENABLED
+				done = !BC_IS_BC;
+#endif // DC_ENABLED
+				bc_vec_pushByte(&types, BC_PROG_TYPE_NUM);
+				break;
+			}
+
+#if DC_ENABLED
+			case BC_INST_POP_EXEC:
+			{
+				done = true;
+				break;
+			}
+
+			case BC_INST_MODEXP:
+			{
+				good = bc_program_verifyPop(&types, 3, 3);
+				bc_vec_pushByte(&types, BC_PROG_TYPE_NUM);
+				break;
+			}
+
+			case BC_INST_DIVMOD:
+			{
+				good = bc_program_verifyNums(&types, 2, 2);
+				break;
+			}
+
+			case BC_INST_EXECUTE:
+			case BC_INST_EXEC_COND:
+			{
+				n = (inst == BC_INST_EXEC_COND);
+				good = bc_program_verifyNums(&types, 1, n);
+				done = true;
+				break;
+			}
+
+			case BC_INST_ASCIIFY:
+			{
+				good = bc_program_verifyPop(&types, 1, 0);
+				bc_vec_pushByte(&types, BC_PROG_TYPE_STR);
+				break;
+			}
+
+			case BC_INST_PRINT_STREAM:
+			{
+				// P leaves what it printed on the stack.
+				good = bc_program_verifyNums(&types, 1, 0);
+				break;
+			}
+
+			case BC_INST_PUSH_TO_VAR:
+			{
+				bc_program_index(code, &i);
+				good = bc_program_verifyPop(&types, 1, 0);
+				break;
+			}
+
+			case BC_INST_PRINT_STACK:
+			{
+				break;
+			}
+
+			case BC_INST_STACK_LEN:
+			{
+				bc_vec_pushByte(&types, BC_PROG_TYPE_NUM);
+				break;
+			}
+
+			case BC_INST_DUPLICATE:
+			{
+				good = bc_program_verifyNums(&types, 1, 0);
+				if (good) bc_vec_pushByte(&types, BC_PROG_TYPE(&types, 0));
+				break;
+			}
+
+			case BC_INST_SWAP:
+			{
+				good = bc_program_verifyNums(&types, 2, 0);
+				if (good) {
+					t = BC_PROG_TYPE(&types, 0);
+					BC_PROG_TYPE(&types, 0) = BC_PROG_TYPE(&types, 1);
+					BC_PROG_TYPE(&types, 1) = t;
+				}
+				break;
+			}
+
+			case BC_INST_LOAD:
+			case BC_INST_PUSH_VAR:
+			{
+				bc_program_index(code, &i);
+				bc_vec_pushByte(&types, BC_PROG_TYPE_ANY);
+				break;
+			}
+#endif // DC_ENABLED
+
+			default:
+			{
+				good = false;
+				break;
+			}
+		}
+
+#if BC_ENABLED
+		if (BC_IS_BC) {
+
+			if (dead) {
+				good = true;
+				reach = false;
+			}
+
+			// Labels cannot be in the middle of an instruction.
+			for (n = start + 1; good && n < i; ++n) {
+				ptr = bc_vec_item(&depths, n - bgn);
+				good = (*ptr == BC_PROG_DEPTH_NONE);
+			}
+		}
+#endif // BC_ENABLED
+	}
+
+#if BC_ENABLED
+	bc_vec_free(&depths);
+#endif // BC_ENABLED
+	bc_vec_free(&types);
+
+	return good;
+}
+
+static bool bc_program_verified(BcProgram *p, size_t fidx) {
+
+	BcFunc *f;
+
+	// The code of read() is different every time.
+	if (fidx == BC_PROG_READ) return false;
+
+	f = bc_vec_item(&p->fns, fidx);
+
+	if (f->verified == BC_FUNC_CHECK_UNKNOWN) {
+		bool good = bc_program_verify(f, 0);
+		f->verified = good ? BC_FUNC_CHECK_YES : BC_FUNC_CHECK_NO;
+	}
+
+	return f->verified == BC_FUNC_CHECK_YES;
+}
+
+static BcStatus bc_program_read(BcProgram *p) {
+
+	BcStatus s;
+	BcParse parse;
+	BcVec buf;
+	BcInstPtr ip;
+	size_t i;
+	const char* file;
+	BcFunc *f = bc_vec_item(&p->fns, BC_PROG_READ);
+
+	for (i = 0; i < p->stack.len; ++i) {
+		BcInstPtr *ip_ptr = bc_vec_item(&p->stack, i);
+		if (ip_ptr->func == BC_PROG_READ)
+			return bc_vm_err(BC_ERROR_EXEC_REC_READ);
+	}
+
+	file = vm->file;
+	bc_lex_file(&parse.l, bc_program_stdin_name);
+	bc_vec_npop(&f->code, f->code.len);
+	bc_vec_init(&buf, sizeof(char), NULL);
+
+	s = bc_read_line(&buf, BC_IS_BC ? "read> " : "?> ");
+	if (BC_ERR(s)) {
+		if (s == BC_STATUS_EOF) s = bc_vm_err(BC_ERROR_EXEC_READ_EXPR);
+		goto io_err;
+	}
+
+	bc_parse_init(&parse, p, BC_PROG_READ);
+
+	s = bc_parse_text(&parse, buf.v);
+	if (BC_ERR(s)) goto exec_err;
+	s = vm->expr(&parse, BC_PARSE_NOREAD | BC_PARSE_NEEDVAL);
+	if (BC_ERR(s)) goto exec_err;
+
+	if (BC_ERR(parse.l.t != BC_LEX_NLINE && parse.l.t != BC_LEX_EOF)) {
+		s = bc_vm_err(BC_ERROR_EXEC_READ_EXPR);
+		goto exec_err;
+	}
+
+	if (BC_G) bc_program_prepGlobals(p);
+
+	ip.func = BC_PROG_READ;
+	ip.idx = 0;
+	ip.len = p->results.len;
+	ip.checks = true;
+
+	// Update this pointer, just in case.
+	f = bc_vec_item(&p->fns, BC_PROG_READ);
+
+	bc_vec_pushByte(&f->code, vm->read_ret);
+	bc_vec_push(&p->stack, &ip);
+#if DC_ENABLED
+	if (!BC_IS_BC) {
+		size_t temp = 0;
+		bc_vec_push(&p->tail_calls, &temp);
+	}
+#endif // DC_ENABLED
+
+exec_err:
+	bc_parse_free(&parse);
+io_err:
+	bc_vec_free(&buf);
+	vm->file = file;
+	return s;
+}
+
+static void bc_program_printChars(const char *str) {
+	const char *nl;
+	vm->nchars += bc_vm_printf("%s", str);
+	nl = strrchr(str, '\n');
+	if (nl) vm->nchars = strlen(nl + 1);
+}
+
+// The escapes were processed when the string was added, so this only has to
+// write them out and move the column to where they end.
+static void bc_program_printString(const BcStr *restrict s) {
+
+#if DC_ENABLED
+	if (!s->len && !BC_IS_BC) {
+		bc_vm_putchar('\0');
+		return;
+	}
+#endif // DC_ENABLED
+
+	bc_vm_puts(s->esc, stdout);
+
+	if (s->col != SIZE_MAX) vm->nchars = s->col;
+	else vm->nchars += s->len;
+}
+
+static BcStatus bc_program_print(BcProgram *p, uchar inst, size_t idx) {
+
+	BcStatus s = BC_STATUS_SUCCESS;
+	BcResult *r;
+	BcNum *n;
+	bool pop = (inst != BC_INST_PRINT);
+
+	assert(p != NULL);
+
+#ifndef BC_PROG_NO_STACK_CHECK
+	s = bc_program_checkStack(p, idx + 1);
+	if (BC_ERR(s)) return s;
+#endif // BC_PROG_NO_STACK_CHECK
+
+	r = bc_vec_item_rev(&p->results, idx);
+
+#if BC_ENABLED
+	if (r->t == BC_RESULT_VOID) {
+		if (BC_ERR(pop)) return bc_vm_err(BC_ERROR_EXEC_VOID_VAL);
+		bc_vec_pop(&p->results);
+		return s;
+	}
+#endif // BC_ENABLED
+
+	s = bc_program_num(p, r, &n);
+	if (BC_ERR(s)) return s;
+
+	if (BC_PROG_NUM(r, n)) {
+		assert(inst != BC_INST_PRINT_STR);
+		s = bc_num_print(n, BC_PROG_OBASE(p), !pop);
+#if BC_ENABLED
+		if (BC_NO_ERR(!s) && BC_IS_BC) {
+
+			// The result is popped right after this, so if it owns its number,
+			// that number can be moved into last instead of copied.
+			if (r->t == BC_RESULT_TEMP || r->t == BC_RESULT_IBASE ||
+			    r->t == BC_RESULT_OBASE || r->t == BC_RESULT_SCALE)
+			{
+				BcNum temp;
+				memcpy(&temp, &p->last, sizeof(BcNum));
+				memcpy(&p->last, n, sizeof(BcNum));
+				memcpy(n, &temp, sizeof(BcNum));
+			}
+			else bc_num_copy(&p->last, n);
+		}
+#endif // BC_ENABLED
+	}
+	else {
+
+		size_t i = (r->t == BC_RESULT_STR) ? r->d.loc.loc : n->scale;
+
+		if (inst == BC_INST_PRINT_STR)
+			bc_program_printChars(bc_program_str(p, i));
+		else {
+			bc_program_printString(bc_program_string(p, i));
+			if (inst == BC_INST_PRINT) bc_vm_putchar('\n');
+		}
+	}
+
+	if (BC_NO_ERR(!s) && (BC_IS_BC || pop)) bc_vec_pop(&p->results);
+
+	return s;
+}
+
+void bc_program_negate(BcResult *r, BcNum *n) {
+	BcNum *rn = &r->d.n;
+	bc_num_copy(rn, n);
+	if (BC_NUM_NONZERO(rn)) rn->neg = !rn->neg;
+}
+
+void bc_program_not(BcResult *r, BcNum *n) {
+	if (!bc_num_cmpZero(n)) bc_num_one(&r->d.n);
+}
+
+#if BC_ENABLE_EXTRA_MATH
+void bc_program_trunc(BcResult *r, BcNum *n) {
+	BcNum *rn = &r->d.n;
+	bc_num_copy(rn, n);
+	bc_num_truncate(rn, n->scale);
+}
+#endif // BC_ENABLE_EXTRA_MATH
+
+static BcStatus bc_program_unary(BcProgram *p, uchar inst) {
+
+	BcStatus s;
+	BcResult res, *ptr;
+	BcNum *num;
+
+	s = bc_program_prep(p, &ptr, &num);
+	if (BC_ERR(s)) return s;
+
+	bc_num_init(&res.d.n, num->len);
+	bc_program_unarys[inst - BC_INST_NEG](&res, num);
+	bc_program_retire(p, &res, BC_RESULT_TEMP);
+
+	return s;
+}
+
+static BcStatus bc_program_logical(BcProgram *p, uchar inst) {
+
+	BcStatus s;
+	BcResult *opd1, *opd2, res;
+	BcNum *n1, *n2;
+	bool cond = 0;
+	ssize_t cmp;
+
+	s = bc_program_binOpPrep(p, &opd1, &n1, &opd2, &n2);
+	if (BC_ERR(s)) return s;
+
+	if (inst == BC_INST_BOOL_AND)
+		cond = (bc_num_cmpZero(n1) && bc_num_cmpZero(n2));
+	else if (inst == BC_INST_BOOL_OR)
+		cond = (bc_num_cmpZero(n1) || bc_num_cmpZero(n2));
+	else {
+
+		cmp = bc_num_cmp(n1, n2);
+
+#if BC_ENABLE_SIGNALS
+		if (BC_NUM_CMP_SIGNAL(cmp)) return BC_STATUS_SIGNAL;
+#endif // BC_ENABLE_SIGNALS
+
+		switch (inst) {
+
+			case BC_INST_REL_EQ:
+			{
+				cond = (cmp == 0);
+				break;
+			}
+
+			case BC_INST_REL_LE:
+			{
+				cond = (cmp <= 0);
+				break;
+			}
+
+			case BC_INST_REL_GE:
+			{
+				cond = (cmp >= 0);
+				break;
+			}
+
+			case BC_INST_REL_NE:
+			{
+				cond = (cmp != 0);
+				break;
+			}
+
+			case BC_INST_REL_LT:
+			{
+				cond = (cmp < 0);
+				break;
+			}
+
+			case BC_INST_REL_GT:
+			{
+				cond = (cmp > 0);
+				break;
+			}
+#ifndef NDEBUG
+			default:
+			{
+				assert(false);
+				break;
+			}
+#endif // NDEBUG
+		}
+	}
+
+	bc_num_init(&res.d.n, BC_NUM_DEF_SIZE);
+	if (cond) bc_num_one(&res.d.n);
+
+	bc_program_binOpRetire(p, &res);
+
+	return s;
+}
+
+#if DC_ENABLED
+static BcStatus bc_program_assignStr(BcProgram *p, BcResult *r,
+                                     BcVec *v, bool push)
+{
+	BcNum n2;
+
+	memset(&n2, 0, sizeof(BcNum));
+	n2.num = NULL;
+	n2.scale = r->d.loc.loc;
+
+	if (!push) {
+#ifndef BC_PROG_NO_STACK_CHECK
+		BcStatus s = bc_program_checkStack(p, 2);
+		if (BC_ERR(s)) return s;
+#endif // BC_PROG_NO_STACK_CHECK
+		bc_vec_pop(v);
+		bc_vec_pop(&p->results);
+	}
+
+	bc_vec_pop(&p->results);
+	bc_vec_push(v, &n2);
+
+	return BC_STATUS_SUCCESS;
+}
+#endif // DC_ENABLED
+
+static BcStatus bc_program_copyToVar(BcProgram *p, size_t idx,
+                                     BcType t, bool last)
+{
+	BcStatus s = BC_STATUS_SUCCESS;
+	BcResult *ptr, r;
+	BcVec *vec;
+	BcNum *n = NULL;
+	bool var = (t == BC_TYPE_VAR);
+
+#if BC_ENABLED
+#if DC_ENABLED
+	if (!BC_IS_BC) s = bc_program_operand(p, &ptr, &n, 0);
+	else
+#endif // DC_ENABLED
+	{
+		ptr = bc_vec_top(&p->results);
+
+		s = bc_program_type_match(ptr, t);
+		if (BC_ERR(s)) return s;
+
+		if (last) s = bc_program_num(p, ptr, &n);
+		else if (var)
+			n = bc_vec_item_rev(bc_program_vec(p, ptr->d.loc.loc, t), 1);
+	}
+#else // BC_ENABLED
+	s = bc_program_operand(p, &ptr, &n, 0);
+#endif // BC_ENABLED
+
+	if (BC_ERR(s)) return s;
+
+	vec = bc_program_vec(p, idx, t);
+
+#if DC_ENABLED
+	if (ptr->t == BC_RESULT_STR) {
+		if (BC_ERR(!var)) return bc_vm_err(BC_ERROR_EXEC_TYPE);
+		return bc_program_assignStr(p, ptr, vec, true);
+	}
+#endif // DC_ENABLED
+
+	if (var) bc_num_createCopy(&r.d.n, n);
+	else {
+
+		BcVec *v = (BcVec*) n, *rv = &r.d.v;
+#if BC_ENABLED
+		BcVec *parent;
+		bool ref, ref_size;
+
+		parent = bc_program_vec(p, ptr->d.loc.loc, t);
+		assert(parent != NULL);
+
+		if (!last) v = bc_vec_item_rev(parent, !last);
+		assert(v != NULL);
+
+		ref = (v->size == sizeof(BcNum) && t == BC_TYPE_REF);
+		ref_size = (v->size == sizeof(uchar));
+
+		if (ref || (ref_size && t == BC_TYPE_REF)) {
+
+			bc_vec_init(rv, sizeof(uchar), NULL);
+
+			if (ref) {
+
+				assert(parent->len >= (size_t) (!last + 1));
+
+				// Make sure the pointer was not invalidated.
+				vec = bc_program_vec(p, idx, t);
+
+				bc_vec_pushIndex(rv, ptr->d.loc.loc);
+				bc_vec_pushIndex(rv, parent->len - !last - 1);
+			}
+			// If we get here, we are copying a ref to a ref.
+			else bc_vec_npush(rv, v->len * sizeof(uchar), v->v);
+
+			// We need to return early.
+			bc_vec_push(vec, &r.d);
+			bc_vec_pop(&p->results);
+
+			return s;
+		}
+		else if (ref_size && t != BC_TYPE_REF) v = bc_program_dereference(p, v);
+#endif // BC_ENABLED
+
+		bc_array_init(rv, true);
+		bc_array_copy(rv, v);
+	}
+
+	bc_vec_push(vec, &r.d);
+	bc_vec_pop(&p->results);
+
+	return s;
+}
+
+static BcStatus bc_program_setGlobal(BcProgram *p, size_t g, const BcNum *n) {
+
+	BcStatus s;
+	BcBigDig val, max, min = 0;
+	BcBigDig *ptr;
+
+	s = bc_num_bigdig(n, &val);
+	if (BC_ERR(s)) return s;
+
+	if (g != BC_PROG_GLOBALS_SCALE) {
+		min = BC_NUM_MIN_BASE;
+		if (BC_ENABLE_EXTRA_MATH && g == BC_PROG_GLOBALS_OBASE &&
+		    (!BC_IS_BC || !BC_IS_POSIX))
+		{
+			min = 0;
+		}
+	}
+
+	max = vm->maxes[g];
+
+	if (BC_ERR(val > max || val < min))
+		return bc_vm_verr((BcError) (BC_ERROR_EXEC_IBASE + g), min, max);
+
+	ptr = bc_vec_top(p->globals_v + g);
+	*ptr = val;
+	p->globals[g] = val;
+
+	return s;
+}
+
+static BcStatus bc_program_assign(BcProgram *p, uchar inst) {
+
+	BcStatus s;
+	BcResult *left, *right, res;
+	BcNum *l, *r;
+	bool use_val = BC_INST_USE_VAL(inst);
+
+	s = bc_program_assignPrep(p, &left, &l, &right, &r);
+	if (BC_ERR(s)) return s;
+
+#if DC_ENABLED
+	assert(left->t != BC_RESULT_STR);
+
+	if (right->t == BC_RESULT_STR) {
+
+		size_t idx = right->d.loc.loc;
+
+		if (left->t == BC_RESULT_ARRAY_ELEM) {
+			bc_num_free(l);
+			memset(l, 0, sizeof(BcNum));
+			l->num = NULL;
+			l->scale = idx;
+		}
+		else {
+			BcVec *v = bc_program_vec(p, left->d.loc.loc, BC_TYPE_VAR);
+			s = bc_program_assignStr(p, right, v, false);
+		}
+
+		return s;
+	}
+#endif // DC_ENABLED
+
+	if (BC_INST_IS_ASSIGN(inst)) bc_num_copy(l, r);
+#if BC_ENABLED
+	else {
+
+		BcBigDig scale = BC_PROG_SCALE(p);
+		uchar op;
+
+		if (!use_val)
+			inst -= (BC_INST_ASSIGN_POWER_NO_VAL - BC_INST_ASSIGN_POWER);
+
+		op = inst - BC_INST_ASSIGN_POWER + BC_INST_POWER;
+
+		if (BC_PROG_SMALL_OP(op) && BC_NUM_SMALL(l) && BC_NUM_SMALL(r)) {
+			if (op == BC_INST_MULTIPLY) bc_num_smallMul(l, r, l);
+			else bc_num_smallAdd(l, r, l, op == BC_INST_MINUS);
+		}
+		else {
+			s = bc_program_ops[op - BC_INST_POWER](l, r, l, scale);
+			if (BC_ERR(s)) return s;
+		}
+	}
+#endif // BC_ENABLED
+
+	if (left->t >= BC_RESULT_IBASE && left->t <= BC_RESULT_SCALE) {
+		s = bc_program_setGlobal(p, left->t - BC_RESULT_IBASE, l);
+		if (BC_ERR(s)) return s;
+	}
+
+	if (use_val) {
+		bc_num_createCopy(&res.d.n, l);
+		bc_program_binOpRetire(p, &res);
+	}
+	else {
+		bc_vec_pop(&p->results);
+		bc_vec_pop(&p->results);
+	}
+
+	return s;
+}
+
+static BcStatus bc_program_pushVar(BcProgram *p, const char *restrict code,
+                                   size_t *restrict bgn, bool pop, bool copy)
+{
+	BcStatus s = BC_STATUS_SUCCESS;
+	BcResult r;
+	size_t idx = bc_program_index(code, bgn);
+
+	r.t = BC_RESULT_VAR;
+	r.d.loc.loc = idx;
+
+#if DC_ENABLED
+	if (pop || copy) {
+
+		BcVec *v = bc_program_vec(p, idx, BC_TYPE_VAR);
+		BcNum *num = bc_vec_top(v);
+
+		if (BC_ERR(!BC_PROG_STACK(v, 2 - copy)))
+			return bc_vm_err(BC_ERROR_EXEC_STACK);
+
+		if (!BC_PROG_STR(num)) {
+			r.t = BC_RESULT_TEMP;
+			bc_num_createCopy(&r.d.n, num);
+		}
+		else {
+			r.t = BC_RESULT_STR;
+			r.d.loc.loc = num->scale;
+		}
+
+		if (!copy) bc_vec_pop(v);
+	}
+#endif // DC_ENABLED
+
+	bc_vec_push(&p->results, &r);
+
+	return s;
+}
+
+static BcStatus bc_program_pushArray(BcProgram *p, const char *restrict code,
+                                     size_t *restrict bgn, uchar inst)
+{
+	BcStatus s = BC_STATUS_SUCCESS;
+	BcResult r, *operand;
+	BcNum *num;
+	BcBigDig temp;
+
+	r.d.loc.loc = bc_program_index(code, bgn);
+
+#if BC_ENABLED
+	if (inst == BC_INST_ARRAY) {
+		r.t = BC_RESULT_ARRAY;
+		bc_vec_push(&p->results, &r);
+		return s;
+	}
+#endif // BC_ENABLED
+
+	s = bc_program_prep(p, &operand, &num);
+	if (BC_ERR(s)) return s;
+	s = bc_num_bigdig(num, &temp);
+	if (BC_ERR(s)) return s;
+
+	r.d.loc.idx = (size_t) temp;
+	bc_program_retire(p, &r, BC_RESULT_ARRAY_ELEM);
+
+	return s;
+}
+
+#if BC_ENABLED
+static BcStatus bc_program_incdec(BcProgram *p, uchar inst) {
+
+	BcStatus s;
+	BcResult *ptr, res, copy;
+	BcNum *num;
+	uchar inst2;
+	bool post, use_val;
+
+	s = bc_program_prep(p, &ptr, &num);
+	if (BC_ERR(s)) return s;
+
+	use_val = (inst != BC_INST_INC_NO_VAL && inst != BC_INST_DEC_NO_VAL);
+	post = use_val && (inst == BC_INST_INC_POST || inst == BC_INST_DEC_POST);
+
+	if (post) {
+		copy.t = BC_RESULT_TEMP;
+		bc_num_createCopy(&copy.d.n, num);
+	}
+
+	res.t = BC_RESULT_ONE;
+	inst2 = BC_INST_ASSIGN_PLUS;
+
+	if (!use_val) {
+		inst2 += (inst == BC_INST_DEC_NO_VAL);
+		inst2 += (BC_INST_ASSIGN_PLUS_NO_VAL - BC_INST_ASSIGN_PLUS);
+	}
+	else inst2 += (inst & 0x01);
+
+	bc_vec_push(&p->results, &res);
+	s = bc_program_assign(p, inst2);
+
+	if (post) {
+
+		if (BC_ERR(s)) {
+			bc_num_free(&copy.d.n);
+			return s;
+		}
+
+		bc_vec_pop(&p->results);
+		bc_vec_push(&p->results, &copy);
+	}
+
+	return s;
+}
+
+static BcStatus bc_program_series(BcProgram *p, BcFunc *f, bool *done) {
+
+	BcStatus s;
+	BcResult *arg, res;
+	BcNum *n;
+	size_t scale = BC_PROG_SCALE(p);
+
+	*done = false;
+
+	assert(f->nparams == 1 && BC_PROG_STACK(&p->results, 1));
+
+	arg = bc_vec_top(&p->results);
+
+	// Anything odd goes through the library code, errors and all.
+	if (scale < BC_NUM_SERIES_SCALE || arg->t == BC_RESULT_VOID ||
+	    arg->t == BC_RESULT_ARRAY || arg->t == BC_RESULT_STR)
+	{
+		return BC_STATUS_SUCCESS;
+	}
+
+	s = bc_program_num(p, arg, &n);
+	if (BC_ERR(s) || !BC_PROG_NUM(arg, n)) return s;
+
+	bc_num_init(&res.d.n, BC_NUM_RDX(scale) + 1);
+
+	s = bc_num_series(n, &res.d.n, scale, f->series, done);
+
+	if (BC_NO_ERR(!s) && *done) bc_program_retire(p, &res, BC_RESULT_TEMP);
+	else bc_num_free(&res.d.n);
+
+	return s;
+}
+
+static bool bc_program_pure(BcProgram *p, size_t fidx);
+static bool bc_program_closed(BcProgram *p, size_t fidx);
+
+static bool bc_program_isAuto(const BcFunc *f, size_t loc, BcType type) {
+
+	size_t i;
+
+	for (i = 0; i < f->autos.len; ++i) {
+
+		BcLoc *a = bc_vec_item(&f->autos, i);
+
+		if (a->loc != loc) continue;
+		if (a->idx == type) return true;
+		if (type == BC_TYPE_ARRAY && a->idx == BC_TYPE_REF) return true;
+	}
+
+	return false;
+}
+
+// A function is closed if it only touches its own parameters and autos and
+// only calls closed functions, so what it does cannot depend on who called it.
+// A function is pure if it is closed, has no reference parameters, does no
+// I/O, and does not use last. It may use and set ibase, obase, and scale,
+// because those are part of the memoization key, and calls that leave them
+// changed are not memoized. Mutual recursion is treated as neither; self
+// recursion is fine.
+static bool bc_program_checkFunc(BcProgram *p, const BcFunc *f, size_t fidx,
+                                 bool pure)
+{
+	const char *code = f->code.v;
+	size_t i, idx;
+
+	if (!f->code.len || (pure && f->voidfn)) return false;
+
+	for (i = 0; pure && i < f->nparams; ++i) {
+		BcLoc *a = bc_vec_item(&f->autos, i);
+		if (a->idx != BC_TYPE_VAR) return false;
+	}
+
+	for (i = 0; i < f->code.len;) {
+
+		uchar inst = (uchar) code[i++];
+
+		switch (inst) {
+
+			case BC_INST_VAR:
+			{
+				idx = bc_program_index(code, &i);
+				if (!bc_program_isAuto(f, idx, BC_TYPE_VAR)) return false;
+				break;
+			}
+
+			case BC_INST_ARRAY_ELEM:
+			case BC_INST_ARRAY:
+			case BC_INST_CACHE:
+			case BC_INST_CACHE_SAVE:
+			case BC_INST_CACHE_CLEAR:
+			{
+				idx = bc_program_index(code, &i);
+				if (!bc_program_isAuto(f, idx, BC_TYPE_ARRAY)) return false;
+				if (inst == BC_INST_CACHE) bc_program_index(code, &i);
+				break;
+			}
+
+			case BC_INST_GLOBAL_SAVE:
+			case BC_INST_GLOBAL_RESTORE:
+			{
+				bc_program_index(code, &i);
+				idx = bc_program_index(code, &i);
+				if (!bc_program_isAuto(f, idx, BC_TYPE_VAR)) return false;
+				break;
+			}
+
+			case BC_INST_GLOBAL_SET:
 			{
-				cond = (cmp < 0);
+				bc_program_index(code, &i);
+			}
+			// Fallthrough.
+			case BC_INST_NUM:
+			case BC_INST_STR:
+			case BC_INST_JUMP:
+			case BC_INST_JUMP_ZERO:
+			{
+				bc_program_index(code, &i);
 				break;
 			}
 
-			case BC_INST_REL_GT:
+			case BC_INST_CALL:
 			{
-				cond = (cmp > 0);
+				bool ok;
+
+				bc_program_index(code, &i);
+				idx = bc_program_index(code, &i);
+
+				if (idx == fidx) ok = true;
+				else if (pure) ok = bc_program_pure(p, idx);
+				else ok = bc_program_closed(p, idx);
+
+				if (!ok) return false;
+
 				break;
 			}
-#ifndef NDEBUG
+
+			case BC_INST_LAST:
+			case BC_INST_READ:
+			case BC_INST_PRINT:
+			case BC_INST_PRINT_POP:
+			case BC_INST_PRINT_STR:
+			case BC_INST_HALT:
+			{
+				if (pure) return false;
+				break;
+			}
+
 			default:
 			{
-				assert(false);
 				break;
 			}
-#endif // NDEBUG
 		}
 	}
 
-	bc_num_init(&res.d.n, BC_NUM_DEF_SIZE);
-	if (cond) bc_num_one(&res.d.n);
+	return true;
+}
 
-	bc_program_binOpRetire(p, &res);
+static bool bc_program_check(BcProgram *p, size_t fidx, bool pure) {
 
-	return s;
+	BcFunc *f = bc_vec_item(&p->fns, fidx);
+	BcFuncCheck *check = pure ? &f->pure : &f->closed;
+	bool res;
+
+	if (*check != BC_FUNC_CHECK_UNKNOWN) return *check == BC_FUNC_CHECK_YES;
+
+	*check = BC_FUNC_CHECK_RUNNING;
+	res = bc_program_checkFunc(p, f, fidx, pure);
+	*check = res ? BC_FUNC_CHECK_YES : BC_FUNC_CHECK_NO;
+
+	return res;
 }
 
-#if DC_ENABLED
-static BcStatus bc_program_assignStr(BcProgram *p, BcResult *r,
-                                     BcVec *v, bool push)
-{
-	BcNum n2;
+static bool bc_program_pure(BcProgram *p, size_t fidx) {
+	return bc_program_check(p, fidx, true);
+}
 
-	memset(&n2, 0, sizeof(BcNum));
-	n2.num = NULL;
-	n2.scale = r->d.loc.loc;
+static bool bc_program_closed(BcProgram *p, size_t fidx) {
+	return bc_program_check(p, fidx, false);
+}
 
-	if (!push) {
-#ifndef BC_PROG_NO_STACK_CHECK
-		BcStatus s = bc_program_checkStack(&p->results, 2);
-		if (BC_ERR(s)) return s;
-#endif // BC_PROG_NO_STACK_CHECK
-		bc_vec_pop(v);
-		bc_vec_pop(&p->results);
-	}
+// A function that uses ibase, obase, or scale directly is assumed to change
+// them. Copying them into variables does not count, and neither do calls,
+// because with -g, a function that changes them restores them when it returns.
+static bool bc_program_checkGlobals(const BcFunc *f) {
 
-	bc_vec_pop(&p->results);
-	bc_vec_push(v, &n2);
+	const char *code = f->code.v;
+	size_t i;
 
-	return BC_STATUS_SUCCESS;
+	for (i = 0; i < f->code.len;) {
+
+		uchar inst = (uchar) code[i++];
+
+		switch (inst) {
+
+			case BC_INST_IBASE:
+			case BC_INST_OBASE:
+			case BC_INST_SCALE:
+			case BC_INST_GLOBAL_RESTORE:
+			case BC_INST_GLOBAL_SET:
+			{
+				return true;
+			}
+
+			case BC_INST_CALL:
+			case BC_INST_CACHE:
+			case BC_INST_GLOBAL_SAVE:
+			{
+				bc_program_index(code, &i);
+			}
+			// Fallthrough.
+			case BC_INST_NUM:
+			case BC_INST_VAR:
+			case BC_INST_ARRAY_ELEM:
+			case BC_INST_ARRAY:
+			case BC_INST_STR:
+			case BC_INST_JUMP:
+			case BC_INST_JUMP_ZERO:
+			case BC_INST_CACHE_SAVE:
+			case BC_INST_CACHE_CLEAR:
+			{
+				bc_program_index(code, &i);
+				break;
+			}
+
+			default:
+			{
+				break;
+			}
+		}
+	}
+
+	return false;
 }
-#endif // DC_ENABLED
 
-static BcStatus bc_program_copyToVar(BcProgram *p, size_t idx,
-                                     BcType t, bool last)
-{
-	BcStatus s = BC_STATUS_SUCCESS;
-	BcResult *ptr, r;
-	BcVec *vec;
-	BcNum *n = NULL;
-	bool var = (t == BC_TYPE_VAR);
+static bool bc_program_globals(BcProgram *p, size_t fidx) {
 
-#if BC_ENABLED
-#if DC_ENABLED
-	if (!BC_IS_BC) s = bc_program_operand(p, &ptr, &n, 0);
-	else
-#endif // DC_ENABLED
-	{
-		ptr = bc_vec_top(&p->results);
+	BcFunc *f;
 
-		s = bc_program_type_match(ptr, t);
-		if (BC_ERR(s)) return s;
+	// The code of read() is different every time, and it can assign anything.
+	if (fidx == BC_PROG_READ) return true;
 
-		if (last) s = bc_program_num(p, ptr, &n);
-		else if (var)
-			n = bc_vec_item_rev(bc_program_vec(p, ptr->d.loc.loc, t), 1);
+	f = bc_vec_item(&p->fns, fidx);
+
+	if (f->globals == BC_FUNC_CHECK_UNKNOWN) {
+		bool globals = bc_program_checkGlobals(f);
+		f->globals = globals ? BC_FUNC_CHECK_YES : BC_FUNC_CHECK_NO;
 	}
-#else // BC_ENABLED
-	s = bc_program_operand(p, &ptr, &n, 0);
-#endif // BC_ENABLED
 
-	if (BC_ERR(s)) return s;
+	return f->globals == BC_FUNC_CHECK_YES;
+}
 
-	vec = bc_program_vec(p, idx, t);
+// Returns the parameter of f that loc is, or BC_VEC_INVALID_IDX if it is not
+// one of its (number) parameters.
+static size_t bc_program_param(const BcFunc *f, size_t loc) {
 
-#if DC_ENABLED
-	if (ptr->t == BC_RESULT_STR) {
-		if (BC_ERR(!var)) return bc_vm_err(BC_ERROR_EXEC_TYPE);
-		return bc_program_assignStr(p, ptr, vec, true);
+	size_t i;
+
+	for (i = 0; i < f->nparams; ++i) {
+		BcLoc *a = bc_vec_item(&f->autos, i);
+		if (a->loc == loc && a->idx == BC_TYPE_VAR) return i;
 	}
-#endif // DC_ENABLED
 
-	if (var) bc_num_createCopy(&r.d.n, n);
-	else {
+	return BC_VEC_INVALID_IDX;
+}
 
-		BcVec *v = (BcVec*) n, *rv = &r.d.v;
-#if BC_ENABLED
-		BcVec *parent;
-		bool ref, ref_size;
+// A function forwards if all it does is call another function with its own
+// parameters and constants as arguments and return what that returns, like
+// most of the wrappers in the extended math library. If the other function is
+// closed, the forwarding function can be skipped entirely, because it can
+// make no difference which of the two has a stack frame.
+static bool bc_program_checkForward(BcProgram *p, BcFunc *f, size_t fidx) {
 
-		parent = bc_program_vec(p, ptr->d.loc.loc, t);
-		assert(parent != NULL);
+	const char *code = f->code.v;
+	BcFunc *g;
+	size_t i, idx, nargs, len = f->code.len;
 
-		if (!last) v = bc_vec_item_rev(parent, !last);
-		assert(v != NULL);
+	if (!len) return false;
 
-		ref = (v->size == sizeof(BcNum) && t == BC_TYPE_REF);
-		ref_size = (v->size == sizeof(uchar));
+	for (i = 0; i < f->nparams; ++i) {
+		BcLoc *a = bc_vec_item(&f->autos, i);
+		if (a->idx != BC_TYPE_VAR) return false;
+	}
 
-		if (ref || (ref_size && t == BC_TYPE_REF)) {
+	for (i = 0, nargs = 0; i < len && code[i] != BC_INST_CALL; ++nargs) {
 
-			bc_vec_init(rv, sizeof(uchar), NULL);
+		uchar inst = (uchar) code[i++];
 
-			if (ref) {
+		if (inst == BC_INST_VAR) {
+			idx = bc_program_index(code, &i);
+			if (bc_program_param(f, idx) == BC_VEC_INVALID_IDX) return false;
+		}
+		else if (inst == BC_INST_NUM) bc_program_index(code, &i);
+		else if (inst != BC_INST_ONE) return false;
+	}
 
-				assert(parent->len >= (size_t) (!last + 1));
+	if (i == len) return false;
 
-				// Make sure the pointer was not invalidated.
-				vec = bc_program_vec(p, idx, t);
+	i += 1;
+	if (bc_program_index(code, &i) != nargs) return false;
+	idx = bc_program_index(code, &i);
 
-				bc_vec_pushIndex(rv, ptr->d.loc.loc);
-				bc_vec_pushIndex(rv, parent->len - !last - 1);
-			}
-			// If we get here, we are copying a ref to a ref.
-			else bc_vec_npush(rv, v->len * sizeof(uchar), v->v);
+	// A void function ends with printing the void result and returning.
+	if (i + 2 != len) return false;
+	if ((uchar) code[i] != (f->voidfn ? BC_INST_PRINT : BC_INST_RET))
+		return false;
+	if ((uchar) code[i + 1] != (f->voidfn ? BC_INST_RET_VOID : BC_INST_RET0))
+		return false;
 
-			// We need to return early.
-			bc_vec_push(vec, &r.d);
-			bc_vec_pop(&p->results);
+	g = bc_vec_item(&p->fns, idx);
 
-			return s;
-		}
-		else if (ref_size && t != BC_TYPE_REF) v = bc_program_dereference(p, v);
-#endif // BC_ENABLED
+	if (idx == fidx || !g->code.len || g->voidfn != f->voidfn ||
+	    g->nparams != nargs || !bc_program_closed(p, idx))
+	{
+		return false;
+	}
 
-		bc_array_init(rv, true);
-		bc_array_copy(rv, v);
+	for (i = 0; i < g->nparams; ++i) {
+		BcLoc *a = bc_vec_item(&g->autos, i);
+		if (a->idx != BC_TYPE_VAR) return false;
 	}
 
-	bc_vec_push(vec, &r.d);
-	bc_vec_pop(&p->results);
+	f->fwd_func = idx;
 
-	return s;
+	return true;
 }
 
-static BcStatus bc_program_assign(BcProgram *p, uchar inst) {
+static bool bc_program_forwards(BcProgram *p, BcFunc *f, size_t fidx) {
 
-	BcStatus s;
-	BcResult *left, *right, res;
-	BcNum *l, *r;
-	bool ob, sc, use_val = BC_INST_USE_VAL(inst);
+	if (f->fwd == BC_FUNC_CHECK_UNKNOWN) {
+		bool fwd = bc_program_checkForward(p, f, fidx);
+		f->fwd = fwd ? BC_FUNC_CHECK_YES : BC_FUNC_CHECK_NO;
+	}
 
-	s = bc_program_assignPrep(p, &left, &l, &right, &r);
-	if (BC_ERR(s)) return s;
+	return f->fwd == BC_FUNC_CHECK_YES;
+}
 
-#if DC_ENABLED
-	assert(left->t != BC_RESULT_STR);
+// Replaces the arguments of a call to a forwarding function with the arguments
+// that it would have passed on, or sets ok to false if some argument is not a
+// number. Constants are parsed here because they belong to the forwarding
+// function, not the one that is running.
+static BcStatus bc_program_forward(BcProgram *p, BcFunc *f, size_t nparams,
+                                   bool *ok)
+{
+	BcStatus s = BC_STATUS_SUCCESS;
+	const char *code = f->code.v;
+	size_t i, bgn = p->results.len - nparams;
 
-	if (right->t == BC_RESULT_STR) {
+	*ok = true;
 
-		size_t idx = right->d.loc.loc;
+	for (i = 0; i < nparams; ++i) {
 
-		if (left->t == BC_RESULT_ARRAY_ELEM) {
-			bc_num_free(l);
-			memset(l, 0, sizeof(BcNum));
-			l->num = NULL;
-			l->scale = idx;
+		BcResult *arg = bc_vec_item(&p->results, bgn + i);
+
+		if (BC_ERR(arg->t == BC_RESULT_VOID))
+			return bc_vm_err(BC_ERROR_EXEC_VOID_VAL);
+
+		*ok = (arg->t != BC_RESULT_ARRAY && arg->t != BC_RESULT_STR);
+		if (!*ok) return s;
+	}
+
+	for (i = 0; code[i] != BC_INST_CALL;) {
+
+		uchar inst = (uchar) code[i++];
+		BcResult res;
+
+		if (inst == BC_INST_VAR) {
+			size_t param = bc_program_param(f, bc_program_index(code, &i));
+			bc_result_copy(&res, bc_vec_item(&p->results, bgn + param));
+		}
+		else if (inst == BC_INST_NUM) {
+
+			BcConst *c = bc_vec_item(&f->consts, bc_program_index(code, &i));
+
+			s = bc_program_constNum(p, c);
+			if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+
+			res.t = BC_RESULT_TEMP;
+			bc_num_createCopy(&res.d.n, &c->num);
 		}
 		else {
-			BcVec *v = bc_program_vec(p, left->d.loc.loc, BC_TYPE_VAR);
-			s = bc_program_assignStr(p, right, v, false);
+			assert(inst == BC_INST_ONE);
+			res.t = BC_RESULT_ONE;
 		}
 
-		return s;
+		bc_vec_push(&p->results, &res);
 	}
-#endif // DC_ENABLED
 
-	if (BC_INST_IS_ASSIGN(inst)) bc_num_copy(l, r);
-#if BC_ENABLED
+	if (p->results.len == bgn + nparams) bc_vec_npop(&p->results, nparams);
 	else {
+		for (i = 0; i < nparams; ++i) bc_vec_popAt(&p->results, bgn);
+	}
 
-		BcBigDig scale = BC_PROG_SCALE(p);
+	return s;
+}
 
-		if (!use_val)
-			inst -= (BC_INST_ASSIGN_POWER_NO_VAL - BC_INST_ASSIGN_POWER);
+static void bc_program_memoPush(BcVec *key, size_t val) {
 
-		s = bc_program_ops[inst - BC_INST_ASSIGN_POWER](l, r, l, scale);
-		if (BC_ERR(s)) return s;
-	}
-#endif // BC_ENABLED
+	do {
+		bc_vec_pushByte(key, (uchar) ('a' + (val & 0xf)));
+		val >>= 4;
+	} while (val);
+
+	bc_vec_pushByte(key, ',');
+}
+
+static void bc_program_memoGlobals(BcProgram *p) {
+
+	size_t i;
+
+	bc_vec_npop(&p->memo_key, p->memo_key.len);
+
+	for (i = 0; i < BC_PROG_GLOBALS_LEN; ++i)
+		bc_program_memoPush(&p->memo_key, (size_t) p->globals[i]);
+}
+
+// Builds the key of a call from the globals and the arguments, or sets ok to
+// false if some argument is not a number.
+static BcStatus bc_program_memoKey(BcProgram *p, size_t nparams, bool *ok) {
+
+	BcStatus s;
+	size_t i, j;
 
-	ob = (left->t == BC_RESULT_OBASE);
-	sc = (left->t == BC_RESULT_SCALE);
+	bc_program_memoGlobals(p);
 
-	if (ob || sc || left->t == BC_RESULT_IBASE) {
+	for (i = 0; i < nparams; ++i) {
+
+		BcResult *arg = bc_vec_item_rev(&p->results, i);
+		BcNum *n;
 
-		BcVec *v;
-		BcBigDig *ptr, *ptr_t, val, max, min;
-		BcError e;
+		*ok = (arg->t != BC_RESULT_VOID && arg->t != BC_RESULT_ARRAY &&
+		       arg->t != BC_RESULT_STR);
+		if (!*ok) return BC_STATUS_SUCCESS;
 
-		s = bc_num_bigdig(l, &val);
+		s = bc_program_num(p, arg, &n);
 		if (BC_ERR(s)) return s;
-		e = left->t - BC_RESULT_IBASE + BC_ERROR_EXEC_IBASE;
 
-		if (sc) {
-			min = 0;
-			max = vm->maxes[BC_PROG_GLOBALS_SCALE];
-			v = p->globals_v + BC_PROG_GLOBALS_SCALE;
-			ptr_t = p->globals + BC_PROG_GLOBALS_SCALE;
-		}
-		else {
-			min = BC_NUM_MIN_BASE;
-			if (BC_ENABLE_EXTRA_MATH && ob && (!BC_IS_BC || !BC_IS_POSIX))
-				min = 0;
-			max = vm->maxes[ob + BC_PROG_GLOBALS_IBASE];
-			v = p->globals_v + BC_PROG_GLOBALS_IBASE + ob;
-			ptr_t = p->globals + BC_PROG_GLOBALS_IBASE + ob;
-		}
+		*ok = BC_PROG_NUM(arg, n);
+		if (!*ok) return BC_STATUS_SUCCESS;
 
-		if (BC_ERR(val > max || val < min)) return bc_vm_verr(e, min, max);
+		bc_program_memoPush(&p->memo_key, n->neg);
+		bc_program_memoPush(&p->memo_key, n->scale);
+		bc_program_memoPush(&p->memo_key, n->rdx);
+		bc_program_memoPush(&p->memo_key, n->len);
 
-		ptr = bc_vec_top(v);
-		*ptr = val;
-		*ptr_t = val;
+		for (j = 0; j < n->len; ++j)
+			bc_program_memoPush(&p->memo_key, (size_t) n->num[j]);
 	}
 
-	if (use_val) {
-		bc_num_createCopy(&res.d.n, l);
-		bc_program_binOpRetire(p, &res);
+	bc_vec_pushByte(&p->memo_key, '\0');
+
+	return BC_STATUS_SUCCESS;
+}
+
+// Replaces the arguments with a remembered result, if there is one. If not,
+// the call is pushed onto memo_calls so that its result is saved later.
+static BcStatus bc_program_memoCall(BcProgram *p, BcFunc *f, size_t nparams,
+                                    bool *hit)
+{
+	BcStatus s;
+	BcResult res;
+	BcId id;
+	size_t idx;
+	bool ok;
+
+	*hit = false;
+
+	s = bc_program_memoKey(p, nparams, &ok);
+	if (BC_ERR(s) || !ok) return s;
+
+	id.name = p->memo_key.v;
+	idx = bc_map_index(&f->memo_map, &id);
+
+	if (idx != BC_VEC_INVALID_IDX) {
+
+		BcId *ptr = bc_vec_item(&f->memo_map, idx);
+
+		res.t = BC_RESULT_TEMP;
+		bc_num_createCopy(&res.d.n, bc_vec_item(&f->memo, ptr->idx));
+
+		bc_vec_npop(&p->results, nparams);
+		bc_vec_push(&p->results, &res);
+
+		*hit = true;
 	}
 	else {
-		bc_vec_pop(&p->results);
-		bc_vec_pop(&p->results);
+		id.name = bc_vm_strdup(p->memo_key.v);
+		id.idx = p->stack.len + 1;
+		bc_vec_push(&p->memo_calls, &id);
 	}
 
 	return s;
 }
 
-static BcStatus bc_program_pushVar(BcProgram *p, const char *restrict code,
-                                   size_t *restrict bgn, bool pop, bool copy)
+static void bc_program_memoSave(BcProgram *p, BcFunc *f, BcId *call,
+                                const BcNum *n)
 {
-	BcStatus s = BC_STATUS_SUCCESS;
-	BcResult r;
-	size_t idx = bc_program_index(code, bgn);
-
-	r.t = BC_RESULT_VAR;
-	r.d.loc.loc = idx;
+	BcId id;
+	BcNum copy;
+	size_t idx, size;
 
-#if DC_ENABLED
-	if (pop || copy) {
+	// A call that left a global changed has to be run every time.
+	bc_program_memoGlobals(p);
+	if (strncmp(call->name, p->memo_key.v, p->memo_key.len)) return;
 
-		BcVec *v = bc_program_vec(p, idx, BC_TYPE_VAR);
-		BcNum *num = bc_vec_top(v);
+	size = strlen(call->name) + sizeof(BcId) + sizeof(BcNum);
+	size += BC_NUM_SIZE(n->len);
 
-		s = bc_program_checkStack(v, 2 - copy);
-		if (BC_ERR(s)) return s;
+	if (f->memo_size + size > BC_PROG_MEMO_SIZE) {
+		bc_vec_npop(&f->memo_map, f->memo_map.len);
+		bc_vec_npop(&f->memo, f->memo.len);
+		f->memo_size = 0;
+	}
 
-		if (!BC_PROG_STR(num)) {
-			r.t = BC_RESULT_TEMP;
-			bc_num_createCopy(&r.d.n, num);
-		}
-		else {
-			r.t = BC_RESULT_STR;
-			r.d.loc.loc = num->scale;
-		}
+	id.name = call->name;
+	id.idx = f->memo.len;
 
-		if (!copy) bc_vec_pop(v);
+	if (bc_map_insert(&f->memo_map, &id, &idx)) {
+		bc_num_createCopy(&copy, n);
+		bc_vec_push(&f->memo, &copy);
+		f->memo_size += size;
+		call->name = NULL;
 	}
-#endif // DC_ENABLED
+}
 
-	bc_vec_push(&p->results, &r);
+static void bc_program_popAutos(BcProgram *p, const BcFunc *f) {
 
-	return s;
-}
+	size_t i;
 
-static BcStatus bc_program_pushArray(BcProgram *p, const char *restrict code,
-                                     size_t *restrict bgn, uchar inst)
-{
-	BcStatus s = BC_STATUS_SUCCESS;
-	BcResult r, *operand;
-	BcNum *num;
-	BcBigDig temp;
+	for (i = 0; i < f->autos.len; ++i) {
 
-	r.d.loc.loc = bc_program_index(code, bgn);
+		BcLoc *a = bc_vec_item(&f->autos, i);
+		BcVec *v = bc_program_vec(p, a->loc, (BcType) a->idx);
 
-#if BC_ENABLED
-	if (inst == BC_INST_ARRAY) {
-		r.t = BC_RESULT_ARRAY;
-		bc_vec_push(&p->results, &r);
-		return s;
+		bc_vec_pop(v);
 	}
-#endif // BC_ENABLED
+}
 
-	s = bc_program_prep(p, &operand, &num);
-	if (BC_ERR(s)) return s;
-	s = bc_num_bigdig(num, &temp);
-	if (BC_ERR(s)) return s;
+// Whether a call that is directly followed by a return can reuse the stack
+// frame of the function that makes it. That function's autos are gone by the
+// time the called one runs, so the called one must be closed.
+static bool bc_program_canTail(BcProgram *p, const BcFunc *f, size_t fidx,
+                               size_t nparams)
+{
+	BcInstPtr *ip = bc_vec_top(&p->stack);
+	size_t i;
 
-	r.d.loc.idx = (size_t) temp;
-	bc_program_retire(p, &r, BC_RESULT_ARRAY_ELEM);
+	assert(BC_PROG_STACK(&p->stack, 2));
 
-	return s;
-}
+	if (f->voidfn || p->results.len - nparams != ip->len) return false;
+	if (!bc_program_closed(p, fidx)) return false;
 
-#if BC_ENABLED
-static BcStatus bc_program_incdec(BcProgram *p, uchar inst) {
+	// Whether the globals were saved depends on the function of the frame.
+	if (BC_G && bc_program_globals(p, fidx) != bc_program_globals(p, ip->func))
+		return false;
 
-	BcStatus s;
-	BcResult *ptr, res, copy;
-	BcNum *num;
-	uchar inst2;
-	bool post, use_val;
+	// Memoized results are saved by stack depth.
+	if (BC_M && bc_program_pure(p, fidx)) return false;
+	if (p->memo_calls.len &&
+	    ((BcId*) bc_vec_top(&p->memo_calls))->idx == p->stack.len)
+	{
+		return false;
+	}
 
-	s = bc_program_prep(p, &ptr, &num);
-	if (BC_ERR(s)) return s;
+	for (i = 0; i < nparams; ++i) {
+		BcResult *arg = bc_vec_item_rev(&p->results, i);
+		if (arg->t == BC_RESULT_VOID || arg->t == BC_RESULT_ARRAY ||
+		    arg->t == BC_RESULT_STR)
+		{
+			return false;
+		}
+	}
 
-	use_val = (inst != BC_INST_INC_NO_VAL && inst != BC_INST_DEC_NO_VAL);
-	post = use_val && (inst == BC_INST_INC_POST || inst == BC_INST_DEC_POST);
+	return true;
+}
 
-	if (post) {
-		copy.t = BC_RESULT_TEMP;
-		bc_num_createCopy(&copy.d.n, num);
-	}
+// Turns arguments that refer to variables or constants of the function that
+// is returning into temporaries, or sets ok to false if some are not numbers.
+static BcStatus bc_program_tailArgs(BcProgram *p, size_t nparams, bool *ok) {
 
-	res.t = BC_RESULT_ONE;
-	inst2 = BC_INST_ASSIGN_PLUS;
+	BcStatus s = BC_STATUS_SUCCESS;
+	size_t i;
 
-	if (!use_val) {
-		inst2 += (inst == BC_INST_DEC_NO_VAL);
-		inst2 += (BC_INST_ASSIGN_PLUS_NO_VAL - BC_INST_ASSIGN_PLUS);
-	}
-	else inst2 += (inst & 0x01);
+	for (i = 0; i < nparams; ++i) {
 
-	bc_vec_push(&p->results, &res);
-	s = bc_program_assign(p, inst2);
+		BcResult *arg = bc_vec_item_rev(&p->results, i);
+		BcNum *n;
 
-	if (post) {
+		s = bc_program_num(p, arg, &n);
+		if (BC_ERR(s)) return s;
 
-		if (BC_ERR(s)) {
-			bc_num_free(&copy.d.n);
-			return s;
-		}
+		*ok = BC_PROG_NUM(arg, n);
+		if (!*ok) return s;
 
-		bc_vec_pop(&p->results);
-		bc_vec_push(&p->results, &copy);
+		if (arg->t == BC_RESULT_VAR || arg->t == BC_RESULT_ARRAY_ELEM) {
+			BcNum copy;
+			bc_num_createCopy(&copy, n);
+			arg->t = BC_RESULT_TEMP;
+			memcpy(&arg->d.n, &copy, sizeof(BcNum));
+		}
 	}
 
 	return s;
@@ -1031,6 +2259,7 @@ static BcStatus bc_program_call(BcProgram *p, const char *restrict code,
 	BcLoc *a;
 	BcResultData param;
 	BcResult *arg;
+	bool tail;
 
 	ip.idx = 0;
 	ip.func = bc_program_index(code, idx);
@@ -1040,11 +2269,54 @@ static BcStatus bc_program_call(BcProgram *p, const char *restrict code,
 		return bc_vm_verr(BC_ERROR_EXEC_UNDEF_FUNC, f->name);
 	if (BC_ERR(nparams != f->nparams))
 		return bc_vm_verr(BC_ERROR_EXEC_PARAMS, f->nparams, nparams);
+
+	while (bc_program_forwards(p, f, ip.func)) {
+
+		bool ok;
+
+		s = bc_program_forward(p, f, nparams, &ok);
+		if (BC_ERR(s)) return s;
+		if (!ok) break;
+
+		ip.func = f->fwd_func;
+		f = bc_vec_item(&p->fns, ip.func);
+		nparams = f->nparams;
+	}
+
+	if (f->series) {
+		bool done;
+		s = bc_program_series(p, f, &done);
+		if (BC_ERR(s) || done) return s;
+	}
+
+	if (BC_M && bc_program_pure(p, ip.func)) {
+		bool hit;
+		s = bc_program_memoCall(p, f, nparams, &hit);
+		if (BC_ERR(s) || hit) return s;
+	}
+
+	tail = ((uchar) code[*idx] == BC_INST_RET &&
+	        bc_program_canTail(p, f, ip.func, nparams));
+
+	if (tail) {
+
+		s = bc_program_tailArgs(p, nparams, &tail);
+		if (BC_ERR(s)) return s;
+
+		if (tail) {
+			BcInstPtr *top = bc_vec_top(&p->stack);
+			bc_program_popAutos(p, bc_vec_item(&p->fns, top->func));
+		}
+	}
+
 	ip.len = p->results.len - nparams;
+	ip.checks = !bc_program_verified(p, ip.func);
 
 	assert(BC_PROG_STACK(&p->results, nparams));
 
-	if (BC_G) bc_program_prepGlobals(p);
+	// A tail call keeps the globals that were saved for the frame it reuses.
+	if (BC_G && !tail && bc_program_globals(p, ip.func))
+		bc_program_prepGlobals(p);
 
 	for (i = 0; i < nparams; ++i) {
 
@@ -1087,7 +2359,8 @@ static BcStatus bc_program_call(BcProgram *p, const char *restrict code,
 		}
 	}
 
-	bc_vec_push(&p->stack, &ip);
+	if (tail) memcpy(bc_vec_top(&p->stack), &ip, sizeof(BcInstPtr));
+	else bc_vec_push(&p->stack, &ip);
 
 	return BC_STATUS_SUCCESS;
 }
@@ -1103,7 +2376,7 @@ static BcStatus bc_program_return(BcProgram *p, uchar inst) {
 	assert(BC_PROG_STACK(&p->stack, 2));
 
 #ifndef BC_PROG_NO_STACK_CHECK
-	s = bc_program_checkStack(&p->results, ip->len + (inst == BC_INST_RET));
+	s = bc_program_checkStack(p, ip->len + (inst == BC_INST_RET));
 	if (BC_ERR(s)) return s;
 #endif // BC_PROG_NO_STACK_CHECK
 
@@ -1124,17 +2397,11 @@ static BcStatus bc_program_return(BcProgram *p, uchar inst) {
 	else bc_num_init(&res.d.n, BC_NUM_DEF_SIZE);
 
 	// We need to pop arguments as well, so this takes that into account.
-	for (i = 0; i < f->autos.len; ++i) {
-
-		BcLoc *a = bc_vec_item(&f->autos, i);
-		BcVec *v = bc_program_vec(p, a->loc, (BcType) a->idx);
-
-		bc_vec_pop(v);
-	}
+	bc_program_popAutos(p, f);
 
 	bc_vec_npop(&p->results, p->results.len - ip->len);
 
-	if (BC_G) {
+	if (BC_G && bc_program_globals(p, ip->func)) {
 
 		for (i = 0; i < BC_PROG_GLOBALS_LEN; ++i) {
 			BcVec *v = p->globals_v + i;
@@ -1143,6 +2410,17 @@ static BcStatus bc_program_return(BcProgram *p, uchar inst) {
 		}
 	}
 
+	if (p->memo_calls.len) {
+
+		BcId *call = bc_vec_top(&p->memo_calls);
+
+		if (call->idx == p->stack.len) {
+			if (res.t != BC_RESULT_VOID)
+				bc_program_memoSave(p, f, call, &res.d.n);
+			bc_vec_pop(&p->memo_calls);
+		}
+	}
+
 	bc_vec_push(&p->results, &res);
 	bc_vec_pop(&p->stack);
 
@@ -1167,7 +2445,7 @@ static BcStatus bc_program_builtin(BcProgram *p, uchar inst) {
 
 #if DC_ENABLED
 	if (!len && inst != BC_INST_SCALE_FUNC) {
-		s = bc_program_type_num(opd, num);
+		s = bc_program_type_num(p, opd, num);
 		if (BC_ERR(s)) return s;
 	}
 #endif // DC_ENABLED
@@ -1253,7 +2531,7 @@ static BcStatus bc_program_modexp(BcProgram *p) {
 
 	s = bc_program_operand(p, &r1, &n1, 2);
 	if (BC_ERR(s)) return s;
-	s = bc_program_type_num(r1, n1);
+	s = bc_program_type_num(p, r1, n1);
 	if (BC_ERR(s)) return s;
 
 	s = bc_program_binOpPrep(p, &r2, &n2, &r3, &n3);
@@ -1292,7 +2570,8 @@ static BcStatus bc_program_asciify(BcProgram *p) {
 	BcStatus s;
 	BcResult *r, res;
 	BcNum *n, num;
-	char str[2], *str2, c;
+	char str[2], c;
+	BcStr str2;
 	size_t len;
 	BcBigDig val;
 	BcFunc f, *func;
@@ -1336,15 +2615,14 @@ static BcStatus bc_program_asciify(BcProgram *p) {
 	}
 	else {
 		size_t idx = r->t == BC_RESULT_STR ? r->d.loc.loc : n->scale;
-		str2 = *((char**) bc_vec_item(&func->strs, idx));
-		c = str2[0];
+		c = ((BcStr*) bc_vec_item(&func->strs, idx))->val[0];
 	}
 
 	str[0] = c;
 	str[1] = '\0';
 
 	bc_program_addFunc(p, &f, bc_func_main);
-	str2 = bc_vm_strdup(str);
+	bc_str_init(&str2, bc_vm_strdup(str));
 
 	// Make sure the pointer is updated.
 	func = bc_vec_item(&p->fns, BC_PROG_MAIN);
@@ -1500,6 +2778,7 @@ static BcStatus bc_program_execStr(BcProgram *p, const char *restrict code,
 	ip.idx = 0;
 	ip.len = p->results.len;
 	ip.func = fidx;
+	ip.checks = !bc_program_verified(p, fidx);
 
 	bc_vec_pop(&p->results);
 
@@ -1547,6 +2826,92 @@ static void bc_program_pushBigDig(BcProgram *p, BcBigDig dig, BcResultType type)
 	bc_vec_push(&p->results, &res);
 }
 
+#if BC_ENABLED
+// The values of expressions that the parser found do not change in a loop or
+// repeat in a statement are kept in the first element of hidden arrays. An
+// empty array means that the value has not been computed yet.
+static BcVec* bc_program_cacheArray(const BcProgram *p, size_t idx) {
+
+	BcVec *v = bc_program_vec(p, idx, BC_TYPE_ARRAY);
+
+	v = bc_vec_top(v);
+	assert(v->size == sizeof(BcNum));
+
+	return v;
+}
+
+static bool bc_program_cache(BcProgram *p, size_t idx) {
+
+	BcVec *a = bc_program_cacheArray(p, idx);
+	BcResult r;
+
+	if (!a->len) return false;
+
+	r.t = BC_RESULT_ARRAY_ELEM;
+	r.d.loc.loc = idx;
+	r.d.loc.idx = 0;
+
+	bc_vec_push(&p->results, &r);
+
+	return true;
+}
+
+static BcStatus bc_program_cacheSave(BcProgram *p, size_t idx) {
+
+	BcStatus s;
+	BcVec *a = bc_program_cacheArray(p, idx);
+	BcResult *r;
+	BcNum *n, copy;
+
+	s = bc_program_operand(p, &r, &n, 0);
+	if (BC_ERR(s)) return s;
+
+	bc_vec_npop(a, a->len);
+
+	// The result is replaced by a reference to the saved value, so if it
+	// owns its number, that number can be moved instead of copied.
+	if (r->t == BC_RESULT_TEMP) memcpy(&copy, n, sizeof(BcNum));
+	else bc_num_createCopy(&copy, n);
+
+	bc_vec_push(a, &copy);
+
+	r->t = BC_RESULT_ARRAY_ELEM;
+	r->d.loc.loc = idx;
+	r->d.loc.idx = 0;
+
+	return s;
+}
+
+static void bc_program_cacheClear(BcProgram *p, size_t idx) {
+	BcVec *a = bc_program_cacheArray(p, idx);
+	bc_vec_npop(a, a->len);
+}
+
+// These are for statements that assign a global to a variable, or a variable
+// or a constant to a global, like the ones that save and restore ibase and
+// scale in functions. They skip the results stack and the general assignment.
+static void bc_program_globalSave(BcProgram *p, size_t g, size_t idx) {
+	BcVec *v = bc_program_vec(p, idx, BC_TYPE_VAR);
+	bc_num_bigdig2num(bc_vec_top(v), p->globals[g]);
+}
+
+static BcStatus bc_program_globalRestore(BcProgram *p, size_t g, size_t idx) {
+	BcVec *v = bc_program_vec(p, idx, BC_TYPE_VAR);
+	return bc_program_setGlobal(p, g, bc_vec_top(v));
+}
+
+static BcStatus bc_program_globalSet(BcProgram *p, size_t g, size_t idx) {
+
+	BcStatus s;
+	BcConst *c = bc_program_const(p, idx);
+
+	s = bc_program_constNum(p, c);
+	if (BC_ERROR_SIGNAL_ONLY(s)) return s;
+
+	return bc_program_setGlobal(p, g, &c->num);
+}
+#endif // BC_ENABLED
+
 static void bc_program_pushGlobal(BcProgram *p, uchar inst) {
 
 	BcResultType t;
@@ -1580,6 +2945,8 @@ void bc_program_free(BcProgram *p) {
 #if BC_ENABLED
 	if (BC_IS_BC) {
 		bc_num_free(&p->last);
+		bc_vec_free(&p->memo_calls);
+		bc_vec_free(&p->memo_key);
 	}
 #endif // BC_ENABLED
 
@@ -1624,7 +2991,11 @@ void bc_program_init(BcProgram *p) {
 	bc_num_one(&p->one);
 
 #if BC_ENABLED
-	if (BC_IS_BC) bc_num_init(&p->last, BC_NUM_DEF_SIZE);
+	if (BC_IS_BC) {
+		bc_num_init(&p->last, BC_NUM_DEF_SIZE);
+		bc_vec_init(&p->memo_calls, sizeof(BcId), bc_id_free);
+		bc_vec_init(&p->memo_key, sizeof(char), NULL);
+	}
 #endif // BC_ENABLED
 
 	bc_vec_init(&p->fns, sizeof(BcFunc), bc_func_free);
@@ -1673,14 +3044,48 @@ size_t bc_program_insertFunc(BcProgram *p, char *name) {
 	idx = ((BcId*) bc_vec_item(&p->fn_map, idx))->idx;
 
 	if (!new) {
-		BcFunc *func = bc_vec_item(&p->fns, idx);
-		bc_func_reset(func);
+
+		size_t i;
+
+		// Functions that call this one may not be pure anymore, and what they
+		// returned before may be wrong now.
+		for (i = 0; i < p->fns.len; ++i)
+			bc_func_forget(bc_vec_item(&p->fns, i));
+
+		bc_func_reset(bc_vec_item(&p->fns, idx));
 		free(name);
 	}
 	else bc_program_addFunc(p, &f, name);
 
 	return idx;
 }
+
+void bc_program_libSeries(BcProgram *p) {
+
+	size_t i;
+	BcId id;
+	char name[2];
+
+	assert(p != NULL);
+
+	name[1] = '\0';
+	id.name = name;
+
+	for (i = 0; bc_program_series_fns[i]; ++i) {
+
+		size_t idx;
+
+		name[0] = bc_program_series_fns[i];
+		idx = bc_map_index(&p->fn_map, &id);
+
+		if (idx != BC_VEC_INVALID_IDX) {
+			BcFunc *f;
+			idx = ((BcId*) bc_vec_item(&p->fn_map, idx))->idx;
+			f = bc_vec_item(&p->fns, idx);
+			f->series = name[0];
+		}
+	}
+}
 #endif // BC_ENABLED
 
 BcStatus bc_program_reset(BcProgram *p, BcStatus s) {
@@ -1691,6 +3096,10 @@ BcStatus bc_program_reset(BcProgram *p, BcStatus s) {
 	bc_vec_npop(&p->stack, p->stack.len - 1);
 	bc_vec_npop(&p->results, p->results.len);
 
+#if BC_ENABLED
+	if (BC_IS_BC) bc_vec_npop(&p->memo_calls, p->memo_calls.len);
+#endif // BC_ENABLED
+
 	f = bc_vec_item(&p->fns, 0);
 	ip = bc_vec_top(&p->stack);
 	ip->idx = f->code.len;
@@ -1727,6 +3136,12 @@ BcStatus bc_program_exec(BcProgram *p) {
 	BcNum *num;
 #endif // BC_ENABLED
 
+	// Only the code of main that was not run yet is proven, because the code
+	// that was run may have left results behind.
+	if (ip->func == BC_PROG_MAIN)
+		ip->checks = !bc_program_verify(func, ip->idx);
+	p->checks = ip->checks;
+
 	while (BC_NO_SIG && BC_NO_ERR(!s) && ip->idx < func->code.len) {
 
 		uchar inst = (uchar) code[(ip->idx)++];
@@ -1764,6 +3179,7 @@ BcStatus bc_program_exec(BcProgram *p) {
 				ip = bc_vec_top(&p->stack);
 				func = bc_vec_item(&p->fns, ip->func);
 				code = func->code.v;
+				p->checks = ip->checks;
 				break;
 			}
 
@@ -1792,6 +3208,56 @@ BcStatus bc_program_exec(BcProgram *p) {
 				ip = bc_vec_top(&p->stack);
 				func = bc_vec_item(&p->fns, ip->func);
 				code = func->code.v;
+				p->checks = ip->checks;
+				break;
+			}
+
+			case BC_INST_CACHE:
+			{
+				idx = bc_program_index(code, &ip->idx);
+
+				if (bc_program_cache(p, idx)) {
+
+					size_t *addr;
+
+					idx = bc_program_index(code, &ip->idx);
+					addr = bc_vec_item(&func->labels, idx);
+
+					ip->idx = *addr;
+				}
+				else bc_program_index(code, &ip->idx);
+
+				break;
+			}
+
+			case BC_INST_CACHE_SAVE:
+			{
+				idx = bc_program_index(code, &ip->idx);
+				s = bc_program_cacheSave(p, idx);
+				break;
+			}
+
+			case BC_INST_CACHE_CLEAR:
+			{
+				idx = bc_program_index(code, &ip->idx);
+				bc_program_cacheClear(p, idx);
+				break;
+			}
+
+			case BC_INST_GLOBAL_SAVE:
+			case BC_INST_GLOBAL_RESTORE:
+			case BC_INST_GLOBAL_SET:
+			{
+				size_t g = bc_program_index(code, &ip->idx);
+
+				idx = bc_program_index(code, &ip->idx);
+
+				if (inst == BC_INST_GLOBAL_SAVE)
+					bc_program_globalSave(p, g, idx);
+				else if (inst == BC_INST_GLOBAL_RESTORE)
+					s = bc_program_globalRestore(p, g, idx);
+				else s = bc_program_globalSet(p, g, idx);
+
 				break;
 			}
 #endif // BC_ENABLED
@@ -1811,10 +3277,15 @@ BcStatus bc_program_exec(BcProgram *p) {
 
 			case BC_INST_READ:
 			{
+#if DC_ENABLED
+				// In dc, what read() runs can do anything to the results.
+				if (!BC_IS_BC) p->checks = ip->checks = true;
+#endif // DC_ENABLED
 				s = bc_program_read(p);
 				ip = bc_vec_top(&p->stack);
 				func = bc_vec_item(&p->fns, ip->func);
 				code = func->code.v;
+				p->checks = ip->checks;
 				break;
 			}
 
@@ -1893,8 +3364,39 @@ BcStatus bc_program_exec(BcProgram *p) {
 				break;
 			}
 
-			case BC_INST_POWER:
 			case BC_INST_MULTIPLY:
+			{
+				// A multiply that feeds straight into an add is the pattern
+				// that series loops produce, and one with a constant or a
+				// variable pushed in between is what Horner's rule produces,
+				// so do both at once with a single result.
+				idx = ip->idx;
+
+				if (idx < func->code.len && BC_PROG_FMA_OPD(code[idx])) {
+					if ((uchar) code[idx++] != BC_INST_ONE)
+						bc_program_index(code, &idx);
+				}
+
+				if (idx < func->code.len &&
+				    (uchar) code[idx] == BC_INST_PLUS &&
+				    BC_PROG_STACK(&p->results, 3 - (idx != ip->idx)))
+				{
+					size_t addend = 2;
+
+					if (idx != ip->idx) {
+						bc_program_fmaOperand(p, code, &ip->idx);
+						addend = 0;
+					}
+
+					ip->idx = idx + 1;
+					s = bc_program_fma(p, addend);
+				}
+				else s = bc_program_op(p, inst);
+
+				break;
+			}
+
+			case BC_INST_POWER:
 			case BC_INST_DIVIDE:
 			case BC_INST_MODULUS:
 			case BC_INST_PLUS:
@@ -1953,7 +3455,7 @@ BcStatus bc_program_exec(BcProgram *p) {
 			case BC_INST_POP:
 			{
 #ifndef BC_PROG_NO_STACK_CHECK
-				s = bc_program_checkStack(&p->results, 1);
+				s = bc_program_checkStack(p, 1);
 				if (BC_ERR(s)) return s;
 #endif // BC_PROG_NO_STACK_CHECK
 				bc_vec_pop(&p->results);
@@ -1969,6 +3471,7 @@ BcStatus bc_program_exec(BcProgram *p) {
 				ip = bc_vec_top(&p->stack);
 				func = bc_vec_item(&p->fns, ip->func);
 				code = func->code.v;
+				p->checks = ip->checks;
 				break;
 			}
 
@@ -1988,10 +3491,12 @@ BcStatus bc_program_exec(BcProgram *p) {
 			case BC_INST_EXEC_COND:
 			{
 				cond = (inst == BC_INST_EXEC_COND);
+				p->checks = ip->checks = true;
 				s = bc_program_execStr(p, code, &ip->idx, cond, func->code.len);
 				ip = bc_vec_top(&p->stack);
 				func = bc_vec_item(&p->fns, ip->func);
 				code = func->code.v;
+				p->checks = ip->checks;
 				break;
 			}
 
@@ -2015,7 +3520,7 @@ BcStatus bc_program_exec(BcProgram *p) {
 
 			case BC_INST_DUPLICATE:
 			{
-				s = bc_program_checkStack(&p->results, 1);
+				s = bc_program_checkStack(p, 1);
 				if (BC_ERR(s)) break;
 				ptr = bc_vec_top(&p->results);
 				bc_result_copy(&r, ptr);
@@ -2027,7 +3532,7 @@ BcStatus bc_program_exec(BcProgram *p) {
 			{
 				BcResult *ptr2;
 
-				s = bc_program_checkStack(&p->results, 2);
+				s = bc_program_checkStack(p, 2);
 				if (BC_ERR(s)) break;
 
 				ptr = bc_vec_item_rev(&p->results, 0);
@@ -2045,6 +3550,7 @@ BcStatus bc_program_exec(BcProgram *p) {
 				ip = bc_vec_top(&p->stack);
 				func = bc_vec_item(&p->fns, ip->func);
 				code = func->code.v;
+				p->checks = ip->checks;
 				break;
 			}
 
@@ -2076,6 +3582,7 @@ BcStatus bc_program_exec(BcProgram *p) {
 				ip = bc_vec_top(&p->stack);
 				func = bc_vec_item(&p->fns, ip->func);
 				code = func->code.v;
+				p->checks = ip->checks;
 				break;
 			}
 #endif // DC_ENABLED
@@ -2151,10 +3658,15 @@ void bc_program_printInst(const BcProgram *p, const char *restrict code,
 		bc_vm_printf("(%s)", c->val);
 	}
 	else if (inst == BC_INST_CALL ||
-	         (inst > BC_INST_STR && inst <= BC_INST_JUMP_ZERO))
+	         (inst > BC_INST_STR && inst <= BC_INST_JUMP_ZERO) ||
+	         (inst >= BC_INST_CACHE && inst <= BC_INST_GLOBAL_SET))
 	{
 		bc_program_printIndex(code, bgn);
-		if (inst == BC_INST_CALL) bc_program_printIndex(code, bgn);
+		if (inst == BC_INST_CALL || inst == BC_INST_CACHE ||
+		    inst >= BC_INST_GLOBAL_SAVE)
+		{
+			bc_program_printIndex(code, bgn);
+		}
 	}
 
 	bc_vm_putchar('\n');
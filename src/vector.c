@@ -162,7 +162,6 @@ void bc_vec_empty(BcVec *restrict v) {
 	bc_vec_pushByte(v, '\0');
 }
 
-#if BC_ENABLE_HISTORY
 void bc_vec_popAt(BcVec *restrict v, size_t idx) {
 
 	char* ptr, *data;
@@ -176,9 +175,10 @@ void bc_vec_popAt(BcVec *restrict v, size_t idx) {
 	if (v->dtor != NULL) v->dtor(ptr);
 
 	v->len -= 1;
-	memmove(ptr, data, v->len * v->size);
+	memmove(ptr, data, (v->len - idx) * v->size);
 }
 
+#if BC_ENABLE_HISTORY
 void bc_vec_replaceAt(BcVec *restrict v, size_t idx, const void *data) {
 
 	char *ptr;
@@ -192,6 +192,7 @@ void bc_vec_replaceAt(BcVec *restrict v, size_t idx, const void *data) {
 }
 #endif // BC_ENABLE_HISTORY
 
+#ifndef NDEBUG
 void* bc_vec_item(const BcVec *restrict v, size_t idx) {
 	assert(v != NULL && v->len && idx < v->len);
 	return v->v + v->size * idx;
@@ -201,6 +202,7 @@ void* bc_vec_item_rev(const BcVec *restrict v, size_t idx) {
 	assert(v != NULL && v->len && idx < v->len);
 	return v->v + v->size * (v->len - idx - 1);
 }
+#endif // NDEBUG
 
 void bc_vec_free(void *vec) {
 	BcVec *v = (BcVec*) vec;
@@ -106,6 +106,10 @@ void bc_vm_info(const char* const help) {
 	}
 }
 
+#if BC_ENABLE_THREADS
+static bool bc_vm_outHand(bool wait);
+#endif // BC_ENABLE_THREADS
+
 BcStatus bc_vm_error(BcError e, size_t line, ...) {
 
 	va_list args;
@@ -126,6 +130,9 @@ BcStatus bc_vm_error(BcError e, size_t line, ...) {
 #endif // BC_ENABLED
 
 	// Make sure all of stdout is written first.
+#if BC_ENABLE_THREADS
+	if (vm->out_thread) bc_vm_outHand(true);
+#endif // BC_ENABLE_THREADS
 	fflush(stdout);
 
 	va_start(args, line);
@@ -225,7 +232,199 @@ static size_t bc_vm_envLen(const char *var) {
 	return len;
 }
 
+#if BC_ENABLE_THREADS
+static size_t bc_vm_envThreads(const char *var) {
+
+	char *tenv = getenv(var);
+	size_t i, len, threads = 1;
+	int num;
+
+	if (tenv == NULL) return 0;
+
+	len = strlen(tenv);
+
+	for (num = 1, i = 0; num && i < len; ++i) num = isdigit(tenv[i]);
+
+	if (num && len) {
+		threads = (size_t) atoi(tenv);
+		if (threads < 1 || threads > BC_VM_MAX_THREADS) threads = 1;
+	}
+
+	// The main thread is one of them.
+	return threads - 1;
+}
+
+static void* bc_vm_thread(void *data) {
+	BcVmTask *t = (BcVmTask*) data;
+	t->s = t->f(t->data);
+	return NULL;
+}
+
+void bc_vm_spawn(BcVmTask *t, BcVmTaskFunc f, void *data) {
+
+	t->f = f;
+	t->data = data;
+	t->spawned = false;
+
+	pthread_mutex_lock(&vm->thread_lock);
+
+	if (vm->threads) {
+		vm->threads -= 1;
+		t->spawned = true;
+	}
+
+	pthread_mutex_unlock(&vm->thread_lock);
+
+	if (t->spawned && pthread_create(&t->thread, NULL, bc_vm_thread, t)) {
+
+		pthread_mutex_lock(&vm->thread_lock);
+		vm->threads += 1;
+		pthread_mutex_unlock(&vm->thread_lock);
+
+		t->spawned = false;
+	}
+
+	// If there was no thread to be had, the caller does the work itself.
+	if (!t->spawned) t->s = f(data);
+}
+
+BcStatus bc_vm_join(BcVmTask *t) {
+
+	if (t->spawned) {
+
+		pthread_join(t->thread, NULL);
+
+		pthread_mutex_lock(&vm->thread_lock);
+		vm->threads += 1;
+		pthread_mutex_unlock(&vm->thread_lock);
+
+		t->spawned = false;
+	}
+
+	return t->s;
+}
+
+static void* bc_vm_writer(void *data) {
+
+	BcVec *buf;
+	sigset_t set;
+	bool err;
+
+	BC_UNUSED(data);
+
+	// Signals are for the main thread, except SIGPIPE, which is sent to the
+	// thread that wrote to the closed pipe and has to end bc quietly like it
+	// does without this thread.
+	sigfillset(&set);
+	sigdelset(&set, SIGPIPE);
+	pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+	pthread_mutex_lock(&vm->out_lock);
+
+	while (true) {
+
+		while (!vm->out_full && !vm->out_done)
+			pthread_cond_wait(&vm->out_cond, &vm->out_lock);
+
+		if (!vm->out_full) break;
+
+		buf = vm->out + (vm->out_idx ^ 1);
+
+		pthread_mutex_unlock(&vm->out_lock);
+
+		err = (fwrite(buf->v, 1, buf->len, stdout) != buf->len);
+		err = (fflush(stdout) == EOF || err);
+
+		pthread_mutex_lock(&vm->out_lock);
+
+		vm->out_err = (vm->out_err || err);
+		vm->out_full = false;
+
+		pthread_cond_broadcast(&vm->out_cond);
+	}
+
+	pthread_mutex_unlock(&vm->out_lock);
+
+	return NULL;
+}
+
+// This hands the current buffer to the writer thread once it is done with the
+// other one and, if wait is true, waits for it to be written. It returns true
+// if writing failed, either now or earlier.
+static bool bc_vm_outHand(bool wait) {
+
+	BcVec *buf = vm->out + vm->out_idx;
+	bool err;
+
+	pthread_mutex_lock(&vm->out_lock);
+
+	while (vm->out_full) pthread_cond_wait(&vm->out_cond, &vm->out_lock);
+
+	if (!vm->out_err && buf->len) {
+		vm->out_full = true;
+		vm->out_idx ^= 1;
+		bc_vec_npop(vm->out + vm->out_idx, vm->out[vm->out_idx].len);
+		pthread_cond_broadcast(&vm->out_cond);
+	}
+
+	while (wait && vm->out_full)
+		pthread_cond_wait(&vm->out_cond, &vm->out_lock);
+
+	err = vm->out_err;
+
+	pthread_mutex_unlock(&vm->out_lock);
+
+	return err;
+}
+
+static void bc_vm_outStart(void) {
+
+	bc_vec_init(vm->out, sizeof(uchar), NULL);
+	bc_vec_init(vm->out + 1, sizeof(uchar), NULL);
+	bc_vec_expand(vm->out, BC_VM_OUT_SIZE);
+	bc_vec_expand(vm->out + 1, BC_VM_OUT_SIZE);
+
+	vm->out_idx = 0;
+	vm->out_full = vm->out_done = vm->out_err = false;
+
+	pthread_mutex_init(&vm->out_lock, NULL);
+	pthread_cond_init(&vm->out_cond, NULL);
+
+	vm->out_thread = !pthread_create(&vm->writer, NULL, bc_vm_writer, NULL);
+
+	if (!vm->out_thread) {
+		bc_vec_free(vm->out + 1);
+		bc_vec_free(vm->out);
+	}
+}
+
+static void bc_vm_outStop(void) {
+
+	if (!vm->out_thread) return;
+
+	bc_vm_outHand(true);
+
+	pthread_mutex_lock(&vm->out_lock);
+	vm->out_done = true;
+	pthread_cond_broadcast(&vm->out_cond);
+	pthread_mutex_unlock(&vm->out_lock);
+
+	pthread_join(vm->writer, NULL);
+
+	vm->out_thread = false;
+
+	bc_vec_free(vm->out + 1);
+	bc_vec_free(vm->out);
+}
+#endif // BC_ENABLE_THREADS
+
 void bc_vm_shutdown(void) {
+#ifndef NDEBUG
+	size_t i;
+#endif // NDEBUG
+#if BC_ENABLE_THREADS
+	bc_vm_outStop();
+#endif // BC_ENABLE_THREADS
 #if BC_ENABLE_NLS
 	if (vm->catalog != BC_VM_INVALID_CATALOG) catclose(vm->catalog);
 #endif // BC_ENABLE_NLS
@@ -234,10 +433,15 @@ void bc_vm_shutdown(void) {
 	bc_history_free(&vm->history);
 #endif // BC_ENABLE_HISTORY
 #ifndef NDEBUG
+	for (i = 0; i < BC_NUM_RECIP_CACHE; ++i) {
+		bc_num_free(&vm->recips[i].mu);
+		bc_num_free(&vm->recips[i].m);
+	}
 	bc_vec_free(&vm->files);
 	bc_vec_free(&vm->exprs);
 	bc_program_free(&vm->prog);
 	bc_parse_free(&vm->prs);
+	for (i = 0; i < vm->pool_len; ++i) free(vm->pool[i]);
 	free(vm);
 #endif // NDEBUG
 }
@@ -280,16 +484,49 @@ char* bc_vm_strdup(const char *str) {
 	return s;
 }
 
+#if BC_ENABLE_THREADS
+static void bc_vm_outCheck(void) {
+	BcVec *buf = vm->out + vm->out_idx;
+	if (buf->len >= BC_VM_OUT_SIZE && BC_ERR(bc_vm_outHand(false)))
+		bc_vm_exit(BC_ERROR_FATAL_IO_ERR);
+}
+#endif // BC_ENABLE_THREADS
+
 size_t bc_vm_printf(const char *fmt, ...) {
 
 	va_list args;
 	int ret;
 
-	va_start(args, fmt);
-	ret = vfprintf(stdout, fmt, args);
-	va_end(args);
+#if BC_ENABLE_THREADS
+	if (vm->out_thread) {
 
-	if (BC_IO_ERR(ret, stdout)) bc_vm_exit(BC_ERROR_FATAL_IO_ERR);
+		BcVec *buf = vm->out + vm->out_idx;
+
+		va_start(args, fmt);
+		ret = vsnprintf(NULL, 0, fmt, args);
+		va_end(args);
+
+		if (BC_ERR(ret < 0)) bc_vm_exit(BC_ERROR_FATAL_IO_ERR);
+
+		bc_vec_expand(buf, bc_vm_growSize(buf->len, (size_t) ret + 1));
+
+		va_start(args, fmt);
+		vsnprintf(buf->v + buf->len, (size_t) ret + 1, fmt, args);
+		va_end(args);
+
+		buf->len += (size_t) ret;
+
+		bc_vm_outCheck();
+	}
+	else
+#endif // BC_ENABLE_THREADS
+	{
+		va_start(args, fmt);
+		ret = vfprintf(stdout, fmt, args);
+		va_end(args);
+
+		if (BC_IO_ERR(ret, stdout)) bc_vm_exit(BC_ERROR_FATAL_IO_ERR);
+	}
 
 	vm->nchars = 0;
 
@@ -297,15 +534,35 @@ size_t bc_vm_printf(const char *fmt, ...) {
 }
 
 void bc_vm_puts(const char *str, FILE *restrict f) {
+#if BC_ENABLE_THREADS
+	if (vm->out_thread && f == stdout) {
+		bc_vec_npush(vm->out + vm->out_idx, strlen(str), str);
+		bc_vm_outCheck();
+		return;
+	}
+#endif // BC_ENABLE_THREADS
 	if (BC_IO_ERR(fputs(str, f), f)) bc_vm_exit(BC_ERROR_FATAL_IO_ERR);
 }
 
 void bc_vm_putchar(int c) {
+#if BC_ENABLE_THREADS
+	if (vm->out_thread) {
+		bc_vec_pushByte(vm->out + vm->out_idx, (uchar) c);
+		bc_vm_outCheck();
+	}
+	else
+#endif // BC_ENABLE_THREADS
 	if (BC_IO_ERR(fputc(c, stdout), stdout)) bc_vm_exit(BC_ERROR_FATAL_IO_ERR);
 	vm->nchars = (c == '\n' ? 0 : vm->nchars + 1);
 }
 
 void bc_vm_fflush(FILE *restrict f) {
+#if BC_ENABLE_THREADS
+	if (vm->out_thread && f == stdout) {
+		if (BC_ERR(bc_vm_outHand(true))) bc_vm_exit(BC_ERROR_FATAL_IO_ERR);
+		return;
+	}
+#endif // BC_ENABLE_THREADS
 	if (BC_IO_ERR(fflush(f), f)) bc_vm_exit(BC_ERROR_FATAL_IO_ERR);
 }
 
@@ -598,6 +855,8 @@ static BcStatus bc_vm_exec(const char* env_exp_exit) {
 		s = bc_vm_load(bc_lib_name, bc_lib);
 		if (BC_ERR(s)) return s;
 
+		bc_program_libSeries(&vm->prog);
+
 #if BC_ENABLE_EXTRA_MATH
 		if (!BC_IS_POSIX) {
 			s = bc_vm_load(bc_lib2_name, bc_lib2);
@@ -628,7 +887,8 @@ static BcStatus bc_vm_exec(const char* env_exp_exit) {
 }
 
 BcStatus bc_vm_boot(int argc, char *argv[], const char *env_len,
-                    const char* const env_args, const char* env_exp_exit)
+                    const char* const env_args, const char* env_exp_exit,
+                    const char *env_threads)
 {
 	BcStatus s;
 	int ttyin, ttyout, ttyerr;
@@ -654,6 +914,14 @@ BcStatus bc_vm_boot(int argc, char *argv[], const char *env_len,
 
 	vm->line_len = (uint16_t) bc_vm_envLen(env_len);
 
+#if BC_ENABLE_THREADS
+	vm->main_thread = pthread_self();
+	pthread_mutex_init(&vm->thread_lock, NULL);
+	vm->threads = vm->max_threads = bc_vm_envThreads(env_threads);
+#else // BC_ENABLE_THREADS
+	BC_UNUSED(env_threads);
+#endif // BC_ENABLE_THREADS
+
 	bc_vec_init(&vm->files, sizeof(char*), NULL);
 	bc_vec_init(&vm->exprs, sizeof(uchar), NULL);
 
@@ -683,6 +951,11 @@ BcStatus bc_vm_boot(int argc, char *argv[], const char *env_len,
 
 	vm->tty = (ttyin != 0 && ttyerr != 0);
 
+#if BC_ENABLE_THREADS
+	// A terminal is fast enough, and output to it should appear right away.
+	if (vm->max_threads && !ttyout) bc_vm_outStart();
+#endif // BC_ENABLE_THREADS
+
 	if (BC_IS_POSIX) vm->flags &= ~(BC_FLAG_G);
 
 	vm->maxes[BC_PROG_GLOBALS_IBASE] = BC_NUM_MAX_POSIX_IBASE;